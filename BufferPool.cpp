@@ -0,0 +1,88 @@
+#include "BufferPool.h"
+
+#include <algorithm>
+
+namespace mc_rtc::imgui
+{
+
+namespace
+{
+
+/** Capacity that fits a message of the given size with some headroom */
+size_t capacity_for(size_t size)
+{
+  size_t target = size + size / 4;
+  size_t out = BufferPool::MIN_CAPACITY;
+  while(out < target) { out *= 2; }
+  return out;
+}
+
+size_t histogram_bucket(size_t size)
+{
+  size_t bucket = 0;
+  for(size >>= 10; size != 0 && bucket + 1 < BufferPool::HISTOGRAM_SIZE; size >>= 1) { ++bucket; }
+  return bucket;
+}
+
+} // namespace
+
+BufferPool::BufferPool()
+{ stats_.capacity = MIN_CAPACITY; }
+
+auto BufferPool::acquire() -> Buffer
+{
+  if(free_.empty())
+  {
+    Buffer out;
+    reallocate(out);
+    return out;
+  }
+  auto out = std::move(free_.back());
+  free_.pop_back();
+  if(out.data.size() != stats_.capacity) { reallocate(out); }
+  out.size = 0;
+  return out;
+}
+
+void BufferPool::release(Buffer && buffer)
+{
+  if(buffer.data.size() != stats_.capacity) { reallocate(buffer); }
+  buffer.size = 0;
+  free_.push_back(std::move(buffer));
+}
+
+bool BufferPool::received(Buffer & buffer, size_t size)
+{
+  stats_.messages++;
+  stats_.last = size;
+  stats_.histogram[histogram_bucket(size)]++;
+  stats_.high_water = std::max(stats_.high_water, size);
+  window_high_water_ = std::max(window_high_water_, size);
+  if(++window_messages_ == SHRINK_WINDOW)
+  {
+    /** Shrink back if the recent messages would fit in a buffer less than half the current capacity */
+    auto target = capacity_for(window_high_water_);
+    if(2 * target <= stats_.capacity) { stats_.capacity = target; }
+    window_high_water_ = 0;
+    window_messages_ = 0;
+  }
+  if(size > buffer.data.size())
+  {
+    stats_.truncated++;
+    stats_.capacity = std::max(stats_.capacity, capacity_for(size));
+    reallocate(buffer);
+    buffer.size = 0;
+    return false;
+  }
+  buffer.size = size;
+  return true;
+}
+
+void BufferPool::reallocate(Buffer & buffer)
+{
+  stats_.reallocations++;
+  /** Swap rather than resize so that shrinking actually releases memory */
+  std::vector<char>(stats_.capacity).swap(buffer.data);
+}
+
+} // namespace mc_rtc::imgui
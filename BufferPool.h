@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mc_rtc::imgui
+{
+
+/** Pool of receive buffers for the server messages
+ *
+ * Buffers are sized after the messages received so far: they grow as soon as a message does not fit and shrink back
+ * once large messages stop coming. Buffers are recycled through \ref acquire() and \ref release() so that receiving
+ * messages does not allocate in steady state.
+ *
+ * The pool is not thread-safe, it should only be used by the thread receiving the messages.
+ */
+struct BufferPool
+{
+  /** A pooled buffer */
+  struct Buffer
+  {
+    std::vector<char> data;
+    /** Size of the message held in data */
+    size_t size = 0;
+  };
+
+  /** Number of buckets in \ref Stats::histogram */
+  static constexpr size_t HISTOGRAM_SIZE = 16;
+
+  struct Stats
+  {
+    /** Number of messages received */
+    uint64_t messages = 0;
+    /** Size of the last message received */
+    size_t last = 0;
+    /** Largest message received */
+    size_t high_water = 0;
+    /** Capacity of the buffers handed out by the pool */
+    size_t capacity = 0;
+    /** Number of buffer allocations (growth, shrink or new buffer) */
+    uint64_t reallocations = 0;
+    /** Number of messages that did not fit in their buffer and were lost */
+    uint64_t truncated = 0;
+    /** Message size histogram
+     *
+     * The first bucket counts messages smaller than 1 kiB, bucket i counts messages in [2^(9 + i), 2^(10 + i)) and the
+     * last bucket counts every larger message
+     */
+    std::array<uint64_t, HISTOGRAM_SIZE> histogram = {};
+  };
+
+  /** Smallest buffer capacity */
+  static constexpr size_t MIN_CAPACITY = 65536;
+
+  /** Number of messages over which the pool decides to shrink its buffers */
+  static constexpr size_t SHRINK_WINDOW = 256;
+
+  BufferPool();
+
+  /** Get a buffer with the current capacity */
+  Buffer acquire();
+
+  /** Give a buffer back to the pool */
+  void release(Buffer && buffer);
+
+  /** Record a message of the given size received in buffer
+   *
+   * \returns False if the message did not fit, the buffer is grown to fit the next one
+   */
+  bool received(Buffer & buffer, size_t size);
+
+  inline const Stats & stats() const noexcept { return stats_; }
+
+private:
+  std::vector<Buffer> free_;
+  Stats stats_;
+  /** Largest message in the current shrink window */
+  size_t window_high_water_ = 0;
+  /** Number of messages in the current shrink window */
+  size_t window_messages_ = 0;
+
+  /** Re-allocate the buffer to the current capacity */
+  void reallocate(Buffer & buffer);
+};
+
+} // namespace mc_rtc::imgui
@@ -1,38 +1,69 @@
 #include "Category.h"
 
+#include "Trace.h"
+
 #include "widgets/IndentedSeparator.h"
 
+#include <algorithm>
+
 namespace mc_rtc::imgui
 {
 
-void Category::draw2D()
+namespace
 {
-  for(size_t i = 0; i < widgets.size();)
+
+/** Call draw unless the area it occupied last time is out of view, a placeholder of the same height is drawn then
+ *
+ * \param height Height drawn last time, updated when draw is called, 0 if unknown
+ */
+template<typename DrawT>
+void draw_if_visible(float & height, DrawT && draw)
+{
+  if(height > 0.0f && !ImGui::IsRectVisible(ImVec2(std::max(ImGui::GetContentRegionAvail().x, 1.0f), height)))
   {
-    auto & w = widgets[i];
-    if(w->id.sid == -1)
-    {
-      w->draw2D();
-      ++i;
-      if(i != widgets.size()) { IndentedSeparator(); }
-      continue;
-    }
-    size_t j = i + 1;
-    while(j < widgets.size() && widgets[j]->id.sid == w->id.sid) { ++j; }
-    ImGui::BeginTable(fmt::format("{}_table_{}", w->id.category, i).c_str(), j - i, ImGuiTableFlags_SizingStretchProp);
-    for(; i < j; ++i)
+    /** Dummy adds the item spacing that followed the last item of the widget */
+    ImGui::Dummy(ImVec2(0.0f, height - ImGui::GetStyle().ItemSpacing.y));
+    return;
+  }
+  auto y = ImGui::GetCursorPosY();
+  draw();
+  height = ImGui::GetCursorPosY() - y;
+}
+
+/** Draw widgets[begin, end) as the rows of a single table with the given number of columns */
+void draw_rows(const std::vector<WidgetPtr> & widgets, size_t begin, size_t end, int columns)
+{
+  /** The category is already part of the ImGui ID stack, the position is enough to identify the table */
+  ImGui::PushID(static_cast<int>(begin));
+  if(ImGui::BeginTable("rows", columns, ImGuiTableFlags_SizingStretchProp | ImGuiTableFlags_BordersInnerH))
+  {
+    /** Every row is one line high, only the visible ones are drawn */
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(end - begin));
+    while(clipper.Step())
     {
-      ImGui::TableNextColumn();
-      widgets[i]->draw2D();
+      for(int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
+      {
+        ImGui::TableNextRow();
+        ImGui::PushID(i);
+        widgets[begin + static_cast<size_t>(i)]->draw_row();
+        ImGui::PopID();
+      }
     }
     ImGui::EndTable();
-    if(i != widgets.size()) { IndentedSeparator(); }
   }
+  ImGui::PopID();
+}
+
+} // namespace
+
+void Category::draw2D()
+{
+  MC_RTC_IMGUI_TRACE("Category::draw2D");
+  draw_widgets();
   if(categories.size())
   {
     ImGui::Indent();
-    std::sort(categories.begin(), categories.end(),
-              [](const auto & lhs, const auto & rhs) { return lhs->name < rhs->name; });
     ImGuiTabBarFlags tab_bar_flags = ImGuiTabBarFlags_Reorderable;
     if(ImGui::BeginTabBar(name.c_str(), tab_bar_flags))
     {
@@ -40,6 +71,7 @@ void Category::draw2D()
       {
         if(ImGui::BeginTabItem(cat->name.c_str()))
         {
+          ScopedTimer timer(cat->draw_timings.get());
           cat->draw2D();
           ImGui::EndTabItem();
         }
@@ -50,32 +82,51 @@ void Category::draw2D()
   }
 }
 
-void Category::draw3D()
+void Category::draw_widgets()
 {
-  for(auto & w : widgets) { w->draw3D(); }
-  for(auto & cat : categories) { cat->draw3D(); }
-}
-
-void Category::started()
-{
-  for(auto & w : widgets) { w->seen = false; }
-  for(auto & cat : categories) { cat->started(); }
-}
-
-void Category::stopped()
-{
-  /** Clean up categories first */
-  for(auto & cat : categories) { cat->stopped(); }
-  /** Remove empty categories */
-  {
-    auto it = std::remove_if(categories.begin(), categories.end(),
-                             [](const auto & c) { return c->widgets.size() == 0 && c->categories.size() == 0; });
-    categories.erase(it, categories.end());
-  }
-  /** Remove widgets that have not been seen */
+  for(size_t i = 0; i < widgets.size();)
   {
-    auto it = std::remove_if(widgets.begin(), widgets.end(), [](const auto & w) { return !w->seen; });
-    widgets.erase(it, widgets.end());
+    auto & w = widgets[i];
+    if(w->id.sid == -1 && w->row_columns() != 0)
+    {
+      /** Consecutive widgets that fit the same table layout share a table */
+      int columns = w->row_columns();
+      size_t j = i + 1;
+      while(j < widgets.size() && widgets[j]->id.sid == -1 && widgets[j]->row_columns() == columns) { ++j; }
+      draw_if_visible(w->height, [&]() { draw_rows(widgets, i, j, columns); });
+      i = j;
+      if(i != widgets.size()) { IndentedSeparator(); }
+      continue;
+    }
+    if(w->id.sid == -1)
+    {
+      draw_if_visible(w->height, [&]() { w->draw2D(); });
+      ++i;
+      if(i != widgets.size()) { IndentedSeparator(); }
+      continue;
+    }
+    size_t j = i + 1;
+    while(j < widgets.size() && widgets[j]->id.sid == w->id.sid) { ++j; }
+    /** The height of the group is kept by its first widget */
+    draw_if_visible(w->height,
+                    [&]()
+                    {
+                      /** The category is already part of the ImGui ID stack, the position is enough to identify the
+                       * table */
+                      ImGui::PushID(static_cast<int>(i));
+                      if(ImGui::BeginTable("grouped", static_cast<int>(j - i), ImGuiTableFlags_SizingStretchProp))
+                      {
+                        for(size_t k = i; k < j; ++k)
+                        {
+                          ImGui::TableNextColumn();
+                          widgets[k]->draw2D();
+                        }
+                        ImGui::EndTable();
+                      }
+                      ImGui::PopID();
+                    });
+    i = j;
+    if(i != widgets.size()) { IndentedSeparator(); }
   }
 }
 
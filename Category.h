@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Perf.h"
 #include "Widget.h"
 
 namespace mc_rtc::imgui
@@ -12,19 +13,32 @@ using CategoryPtr = std::unique_ptr<Category>;
 struct Category
 {
   Category() = default;
-  inline Category(const std::string & name, int depth) : name(name), depth(depth) {}
+  inline Category(const std::vector<std::string> & path)
+  : name(path.back()), depth(static_cast<int>(path.size()) - 1), path(path)
+  {
+  }
 
   std::string name = "";
   int depth = -1;
+  /** Full path to this category, empty for the root */
+  std::vector<std::string> path;
+  /** Parent category, nullptr for the root */
+  Category * parent = nullptr;
   std::vector<WidgetPtr> widgets;
+  /** Sub-categories, sorted by name */
   std::vector<CategoryPtr> categories;
+  /** Draw timings, only set for top-level categories when the performance overlay is enabled */
+  std::unique_ptr<PerfCounter> draw_timings;
+  /** True if the category is expanded in the tree view, see \ref CategoryTree */
+  bool expanded = false;
 
   inline bool empty() const { return widgets.size() == 0 && categories.size() == 0; }
 
+  /** Draw the widgets and the sub-categories as tabs */
   void draw2D();
-  void draw3D();
-  void started();
-  void stopped();
+
+  /** Draw the widgets of this category only */
+  void draw_widgets();
 };
 
 } // namespace mc_rtc::imgui
@@ -0,0 +1,88 @@
+#include "CategoryTree.h"
+
+#include "Index.h"
+#include "Trace.h"
+
+namespace mc_rtc::imgui
+{
+
+void CategoryTree::collect(Category & category)
+{
+  for(auto & c : category.categories)
+  {
+    rows_.push_back(c.get());
+    if(c->expanded) { collect(*c); }
+  }
+}
+
+void CategoryTree::draw(Category & root, const Index & index)
+{
+  MC_RTC_IMGUI_TRACE("CategoryTree::draw");
+  if(dirty_)
+  {
+    rows_.clear();
+    collect(root);
+    dirty_ = false;
+  }
+  Category * selected = selected_.size() ? index.category(selected_) : nullptr;
+  auto size = ImGui::GetContentRegionAvail();
+  if(!ImGui::BeginTable("##mc_rtc_tree", 2, ImGuiTableFlags_Resizable | ImGuiTableFlags_BordersInnerV, size))
+  {
+    return;
+  }
+  ImGui::TableSetupColumn("Categories", ImGuiTableColumnFlags_WidthFixed, 0.25f * size.x);
+  ImGui::TableSetupColumn("Content", ImGuiTableColumnFlags_WidthStretch);
+  ImGui::TableNextColumn();
+  if(ImGui::BeginChild("##categories")) { draw_tree(selected); }
+  ImGui::EndChild();
+  ImGui::TableNextColumn();
+  if(ImGui::BeginChild("##content"))
+  {
+    if(selected)
+    {
+      /** Tables drawn by the category are identified by their position, the category disambiguates them */
+      ImGui::PushID(selected);
+      ScopedTimer timer(selected->draw_timings.get());
+      selected->draw_widgets();
+      ImGui::PopID();
+    }
+    else
+    {
+      ImGui::TextDisabled("Select a category");
+    }
+  }
+  ImGui::EndChild();
+  ImGui::EndTable();
+}
+
+void CategoryTree::draw_tree(const Category * selected)
+{
+  const float indent = ImGui::GetStyle().IndentSpacing;
+  ImGuiListClipper clipper;
+  clipper.Begin(static_cast<int>(rows_.size()));
+  while(clipper.Step())
+  {
+    for(int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
+    {
+      auto * cat = rows_[static_cast<size_t>(i)];
+      float offset = static_cast<float>(cat->depth) * indent;
+      if(offset > 0.0f) { ImGui::Indent(offset); }
+      ImGuiTreeNodeFlags flags =
+          ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_SpanAvailWidth | ImGuiTreeNodeFlags_NoTreePushOnOpen;
+      if(cat->categories.empty()) { flags |= ImGuiTreeNodeFlags_Leaf; }
+      if(cat == selected) { flags |= ImGuiTreeNodeFlags_Selected; }
+      ImGui::SetNextItemOpen(cat->expanded, ImGuiCond_Always);
+      bool open = ImGui::TreeNodeEx(cat, flags, "%s", cat->name.c_str());
+      if(ImGui::IsItemClicked() && !ImGui::IsItemToggledOpen()) { selected_ = cat->path; }
+      if(open != cat->expanded && cat->categories.size())
+      {
+        /** The rows change, they are built again on the next frame */
+        cat->expanded = open;
+        dirty_ = true;
+      }
+      if(offset > 0.0f) { ImGui::Unindent(offset); }
+    }
+  }
+}
+
+} // namespace mc_rtc::imgui
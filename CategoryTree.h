@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Category.h"
+
+namespace mc_rtc::imgui
+{
+
+struct Index;
+
+/** Tree view of the categories next to the content of the selected category
+ *
+ * This is an alternative to the nested tab bars drawn by \ref Category::draw2D for large category trees:
+ * - only the expanded nodes are walked to build the rows of the tree, the rows are built again when a category is
+ *   added, removed, expanded or collapsed
+ * - the rows are drawn with a clipper so only the visible ones cost anything
+ * - only the widgets of the selected category are drawn
+ */
+struct CategoryTree
+{
+  /** Draw the tree and the selected category in the remaining space of the current window */
+  void draw(Category & root, const Index & index);
+
+  /** Must be called when a category is added or removed */
+  inline void invalidate() noexcept { dirty_ = true; }
+
+private:
+  /** Categories shown in the tree in display order, i.e. the children of expanded categories */
+  std::vector<Category *> rows_;
+  /** True if rows_ must be built again */
+  bool dirty_ = true;
+  /** Path to the selected category, it is resolved through the index so that the selection is kept if the category
+   * goes away and comes back */
+  std::vector<std::string> selected_;
+
+  /** Add the sub-categories of category to rows_ */
+  void collect(Category & category);
+
+  /** Draw the rows of the tree, selected is highlighted */
+  void draw_tree(const Category * selected);
+};
+
+} // namespace mc_rtc::imgui
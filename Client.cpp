@@ -15,12 +15,67 @@
 #include "widgets/StringInput.h"
 #include "widgets/Table.h"
 
+#include "Trace.h"
+
+#include <nanomsg/nn.h>
+
 #include <boost/filesystem.hpp>
 namespace bfs = boost::filesystem;
 
 namespace mc_rtc::imgui
 {
 
+/** Dispatches a GUI state and only forwards the plot callbacks to the client, every other element is ignored */
+struct Client::PlotReplay : public mc_control::ControllerClient
+{
+  PlotReplay(Client & client) : client_(client) {}
+
+  void replay(const mc_rtc::Configuration & state) { handle_gui_state(state); }
+
+protected:
+  void default_impl(const std::string &, const ElementId &) final {}
+
+  void start_plot(uint64_t id, const std::string & title) override { client_.start_plot(id, title); }
+
+  void plot_setup_xaxis(uint64_t id, const std::string & legend, const mc_rtc::gui::plot::Range & range) override
+  { client_.plot_setup_xaxis(id, legend, range); }
+
+  void plot_setup_yaxis_left(uint64_t id, const std::string & legend, const mc_rtc::gui::plot::Range & range) override
+  { client_.plot_setup_yaxis_left(id, legend, range); }
+
+  void plot_setup_yaxis_right(uint64_t id, const std::string & legend, const mc_rtc::gui::plot::Range & range) override
+  { client_.plot_setup_yaxis_right(id, legend, range); }
+
+  void plot_point(uint64_t id,
+                  uint64_t did,
+                  const std::string & legend,
+                  double x,
+                  double y,
+                  mc_rtc::gui::Color color,
+                  mc_rtc::gui::plot::Style style,
+                  mc_rtc::gui::plot::Side side) override
+  { client_.plot_point(id, did, legend, x, y, color, style, side); }
+
+  void plot_polygon(uint64_t id,
+                    uint64_t did,
+                    const std::string & legend,
+                    const mc_rtc::gui::plot::PolygonDescription & polygon,
+                    mc_rtc::gui::plot::Side side) override
+  { client_.plot_polygon(id, did, legend, polygon, side); }
+
+  void plot_polygons(uint64_t id,
+                     uint64_t did,
+                     const std::string & legend,
+                     const std::vector<mc_rtc::gui::plot::PolygonDescription> & polygons,
+                     mc_rtc::gui::plot::Side side) override
+  { client_.plot_polygons(id, did, legend, polygons, side); }
+
+  void end_plot(uint64_t id) override { client_.end_plot(id); }
+
+private:
+  Client & client_;
+};
+
 Client::Client() : mc_control::ControllerClient()
 {
   std::string socket = fmt::format("ipc://{}", (bfs::temp_directory_path() / "mc_rtc_").string());
@@ -33,11 +88,209 @@ Client::Client(const std::string & sub_conn_uri, const std::string & push_conn_u
 {
 }
 
+Client::Client(Offline) : mc_control::ControllerClient() {}
+
+Client::~Client()
+{ threaded(false); }
+
 void Client::update()
-{ run(buffer_, t_last_); }
+{
+  MC_RTC_IMGUI_TRACE("Client::update");
+  ScopedTimer timer(perf_ ? &perf_->update : nullptr);
+  skipped_messages_ = 0;
+  if(threaded())
+  {
+    t_last_ = last_received_.load();
+    if(states_.consume())
+    {
+      MC_RTC_IMGUI_TRACE("Client::handle_gui_state");
+      auto & batch = states_.front();
+      receive_stats_ = batch.stats;
+      for(size_t i = 0; i + 1 < batch.states.size(); ++i) { handle_skipped_state(batch.states[i]); }
+      handle_gui_state(batch.states.back());
+      batch.states.clear();
+    }
+    else { check_timeout(); }
+    return;
+  }
+  /** Drain the subscription socket, only the latest state is fully applied */
+  auto latest = buffers_.acquire();
+  auto next = buffers_.acquire();
+  for(int recv = receive(next, NN_DONTWAIT); recv >= 0; recv = receive(next, NN_DONTWAIT))
+  {
+    if(recv == 0) { continue; }
+    if(latest.size) { handle_skipped_state(latest.data.data(), latest.size); }
+    std::swap(latest, next);
+  }
+  /** The loop only ends when nn_recv fails, EAGAIN means the socket is drained */
+  if(auto err = nn_errno(); err != EAGAIN && err != EINTR)
+  {
+    mc_rtc::log::error("[mc_rtc::imgui] Failed to receive: {}", nn_strerror(err));
+  }
+  if(latest.size) { handle_message(latest.data.data(), latest.size); }
+  else { check_timeout(); }
+  buffers_.release(std::move(latest));
+  buffers_.release(std::move(next));
+  receive_stats_ = buffers_.stats();
+}
+
+void Widget::invalidate() noexcept
+{
+  data_hash_ = 0;
+  client.invalidate_state();
+}
+
+void Client::handle_message(const char * data, size_t size, bool latest)
+{
+  if(!latest)
+  {
+    handle_skipped_state(data, size);
+    return;
+  }
+  t_last_ = std::chrono::system_clock::now();
+  /** A mostly static GUI often sends the exact same state, there is nothing to update then */
+  auto h = Hash{}.bytes(data, size).value();
+  if(h == state_hash_) { return; }
+  MC_RTC_IMGUI_TRACE("Client::handle_gui_state");
+  state_hash_ = h;
+  handle_gui_state(mc_rtc::Configuration::fromMessagePack(data, size));
+}
+
+void Client::check_timeout()
+{
+  auto now = std::chrono::system_clock::now();
+  if(timeout_ <= 0 || now - t_last_ <= std::chrono::duration<double>(timeout_)) { return; }
+  /** The server went away, remove every element */
+  t_last_ = now;
+  last_received_ = now;
+  state_hash_ = 0;
+  started();
+  stopped();
+}
+
+void Client::record(const std::string & path)
+{
+  std::unique_ptr<Recorder> recorder;
+  if(path.size()) { recorder = std::make_unique<Recorder>(path); }
+  std::lock_guard<std::mutex> lock(recorder_mutex_);
+  recorder_ = std::move(recorder);
+  recording_ = recorder_ != nullptr;
+}
+
+const SlabPool::Stats & Client::form_allocations() const noexcept
+{ return form::Widget::pool().stats(); }
+
+void Client::threaded(bool enable)
+{
+  if(enable == threaded()) { return; }
+  if(enable)
+  {
+    /** Blocking receive with a short timeout so that the thread notices when it should stop */
+    int rcv_timeout = 100;
+    nn_setsockopt(sub_socket_, NN_SOL_SOCKET, NN_RCVTIMEO, &rcv_timeout, sizeof(rcv_timeout));
+    last_received_ = t_last_;
+    network_run_ = true;
+    network_thread_ = std::thread([this]() { network_loop(); });
+  }
+  else
+  {
+    network_run_ = false;
+    network_thread_.join();
+  }
+}
+
+int Client::receive(BufferPool::Buffer & buffer, int flags)
+{
+  int recv = nn_recv(sub_socket_, buffer.data.data(), buffer.data.size(), flags);
+  if(recv < 0) { return recv; }
+  MC_RTC_IMGUI_TRACE_VALUE("message size", recv);
+  if(!buffers_.received(buffer, static_cast<size_t>(recv)))
+  {
+    mc_rtc::log::warning("[mc_rtc::imgui] Receive buffer was too small to receive the latest state message ({} bytes), "
+                         "will resize for next time",
+                         recv);
+    return 0;
+  }
+  if(recording_.load(std::memory_order_relaxed))
+  {
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    std::lock_guard<std::mutex> lock(recorder_mutex_);
+    if(recorder_)
+    {
+      recorder_->write(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count(), buffer.data.data(),
+                       buffer.size);
+    }
+  }
+  return recv;
+}
+
+void Client::network_loop()
+{
+  auto buffer = buffers_.acquire();
+  while(network_run_)
+  {
+    auto recv = receive(buffer, 0);
+    if(recv < 0)
+    {
+      auto err = nn_errno();
+      if(err != EAGAIN && err != ETIMEDOUT && err != EINTR)
+      {
+        mc_rtc::log::error("[mc_rtc::imgui] Network thread failed to receive: {}", nn_strerror(err));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      }
+      continue;
+    }
+    if(recv == 0) { continue; }
+    last_received_ = std::chrono::system_clock::now();
+    auto h = Hash{}.bytes(buffer.data.data(), buffer.size).value();
+    if(h == state_hash_.exchange(h)) { continue; }
+    MC_RTC_IMGUI_TRACE("Client::decode");
+    auto state = mc_rtc::Configuration::fromMessagePack(buffer.data.data(), buffer.size);
+    /** Give the pool a chance to shrink the buffer */
+    buffers_.release(std::move(buffer));
+    buffer = buffers_.acquire();
+    /** If the previous batch was not consumed yet we append to it so that no plot sample is lost */
+    if(!states_.reclaim()) { states_.back().states.clear(); }
+    auto & batch = states_.back();
+    if(batch.states.size() == max_pending_states)
+    {
+      batch.states.erase(batch.states.begin());
+      skipped_total_++;
+    }
+    batch.states.push_back(state);
+    batch.stats = buffers_.stats();
+    states_.publish();
+  }
+  buffers_.release(std::move(buffer));
+}
+
+void Client::handle_skipped_state(const char * data, size_t size)
+{
+  if(active_plots_.empty())
+  {
+    skipped_messages_++;
+    skipped_total_++;
+    return;
+  }
+  handle_skipped_state(mc_rtc::Configuration::fromMessagePack(data, size));
+}
+
+void Client::handle_skipped_state(const mc_rtc::Configuration & state)
+{
+  skipped_messages_++;
+  skipped_total_++;
+  /** Only plots need every state, other elements only care about the latest one */
+  if(active_plots_.empty()) { return; }
+  if(!plot_replay_) { plot_replay_ = std::make_unique<PlotReplay>(*this); }
+  plot_replay_->replay(state);
+}
 
 void Client::draw2D(ImVec2 windowSize)
 {
+  if(perf_) { draw_perf_overlay(); }
+  MC_RTC_IMGUI_TRACE("Client::draw2D");
+  ScopedTimer timer(perf_ ? &perf_->draw2D : nullptr);
+  if(redraw_frames_ > 0) { redraw_frames_--; }
   if(!bold_font_)
   {
     ImGuiIO & io = ImGui::GetIO();
@@ -52,25 +305,34 @@ void Client::draw2D(ImVec2 windowSize)
   {
     ImGui::SetNextWindowPos(ImVec2(left_margin, top_margin), ImGuiCond_FirstUseEver);
     ImGui::SetNextWindowSize(ImVec2(0.4f * width, 0.7f * height), ImGuiCond_FirstUseEver);
-    ImGui::Begin("mc_rtc");
-    root_.draw2D();
+    /** Nothing to draw if the window is collapsed or hidden */
+    if(ImGui::Begin("mc_rtc"))
+    {
+      if(navigation_ == Navigation::Tabs) { root_.draw2D(); }
+      else
+      {
+        root_.draw_widgets();
+        tree_.draw(root_, index_);
+      }
+    }
     ImGui::End();
   }
   if(active_plots_.size() || inactive_plots_.size())
   {
     bool open_plots = true;
-    ImGui::Begin("Plots", active_plots_.size() != 0 ? nullptr : &open_plots);
+    bool visible = ImGui::Begin("Plots", active_plots_.size() != 0 ? nullptr : &open_plots);
     ImGuiTabBarFlags tab_bar_flags = ImGuiTabBarFlags_Reorderable;
-    if(ImGui::BeginTabBar("Plots", tab_bar_flags))
+    if(visible && ImGui::BeginTabBar("Plots", tab_bar_flags))
     {
       size_t id = 0;
       for(auto & p : active_plots_)
       {
-        auto tab_id = fmt::format("{}##{}", p.second->title(), id++);
+        LabelBuffer tab_id(p.second->title(), id++);
         enable_bold_font();
         if(ImGui::BeginTabItem(tab_id.c_str()))
         {
           disable_bold_font();
+          ScopedTimer plot_timer(plot_timings(p.second.get()));
           p.second->do_plot();
           ImGui::EndTabItem();
         }
@@ -82,10 +344,11 @@ void Client::draw2D(ImVec2 windowSize)
       for(auto it = inactive_plots_.begin(); it != inactive_plots_.end();)
       {
         auto & p = *it;
-        auto tab_id = fmt::format("{}##{}", p->title(), id++);
+        LabelBuffer tab_id(p->title(), id++);
         bool open_ = true;
         if(ImGui::BeginTabItem(tab_id.c_str(), &open_))
         {
+          ScopedTimer plot_timer(plot_timings(p.get()));
           p->do_plot();
           ImGui::EndTabItem();
         }
@@ -96,17 +359,123 @@ void Client::draw2D(ImVec2 windowSize)
     ImGui::End();
     if(!open_plots) { inactive_plots_.clear(); }
   }
+  /** Keep drawing while a widget is being edited or dragged */
+  if(ImGui::IsAnyItemActive() || ImGui::GetIO().WantTextInput) { request_redraw(); }
 }
 
 void Client::draw3D()
-{ root_.draw3D(); }
+{
+  ScopedTimer timer(perf_ ? &perf_->draw3D : nullptr);
+  if(!form_widgets3d_valid_ || form_widgets3d_version_ != form::Widget::structure_version())
+  {
+    form_widgets3d_.clear();
+    for(auto * w : widgets3d_) { w->collect3D(form_widgets3d_); }
+    form_widgets3d_valid_ = true;
+    form_widgets3d_version_ = form::Widget::structure_version();
+  }
+  for(auto * w : widgets3d_) { w->draw3D(); }
+  for(auto * w : form_widgets3d_) { w->draw3D(); }
+}
+
+void Client::perf_overlay(bool show)
+{
+  if(show == perf_overlay()) { return; }
+  if(show)
+  {
+    perf_ = std::make_unique<PerfData>();
+    perf_->last_messages = receive_stats_.messages;
+  }
+  else
+  {
+    perf_.reset();
+    for(auto & cat : root_.categories) { cat->draw_timings.reset(); }
+  }
+}
+
+void Client::draw_perf_overlay()
+{
+  auto & perf = *perf_;
+  auto now = std::chrono::steady_clock::now();
+  perf.frame.add(std::chrono::duration<float, std::milli>(now - perf.last_frame).count());
+  perf.last_frame = now;
+  perf.messages.add(static_cast<float>(receive_stats_.messages - perf.last_messages));
+  perf.last_messages = receive_stats_.messages;
+  perf.message_size.add(static_cast<float>(receive_stats_.last) / 1024.0f);
+  for(auto & cat : root_.categories)
+  {
+    if(!cat->draw_timings) { cat->draw_timings = std::make_unique<PerfCounter>(); }
+  }
+  /** Forget the plots that were closed */
+  for(auto it = perf.plots.begin(); it != perf.plots.end();)
+  {
+    bool active = std::any_of(active_plots_.begin(), active_plots_.end(),
+                              [&](const auto & p) { return p.second.get() == it->first; });
+    bool inactive = std::any_of(inactive_plots_.begin(), inactive_plots_.end(),
+                                [&](const auto & p) { return p.get() == it->first; });
+    it = active || inactive ? std::next(it) : perf.plots.erase(it);
+  }
+  bool open = true;
+  if(ImGui::Begin("mc_rtc perf", &open))
+  {
+    auto frame_time = perf.frame.sum();
+    auto rate = frame_time > 0 ? 1000.0f * perf.messages.sum() / frame_time : 0.0f;
+    ImGui::Text("Messages: %.1f Hz, last %.1f kiB, largest %.1f kiB", rate, perf.message_size.last(),
+                static_cast<float>(receive_stats_.high_water) / 1024.0f);
+    ImGui::Text("Skipped messages: %zu (total %llu)", skipped_messages(),
+                static_cast<unsigned long long>(total_skipped_messages()));
+    ImGui::Text("Widgets: %zu, form elements (all clients): %llu, plots: %zu active, %zu closed", seen_.size(),
+                static_cast<unsigned long long>(form_allocations().live), active_plots_.size(),
+                inactive_plots_.size());
+    perf.message_size.plot("##mc_rtc_perf_message_size");
+    if(ImGui::BeginTable("mc_rtc_perf_timings", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit))
+    {
+      ImGui::TableSetupColumn("");
+      ImGui::TableSetupColumn("last (ms)");
+      ImGui::TableSetupColumn("mean (ms)");
+      ImGui::TableSetupColumn("max (ms)");
+      ImGui::TableSetupColumn("history", ImGuiTableColumnFlags_WidthStretch);
+      ImGui::TableHeadersRow();
+      auto row = [](const char * name, const PerfCounter & counter, bool indent = false)
+      {
+        ImGui::PushID(&counter);
+        ImGui::TableNextColumn();
+        if(indent) { ImGui::Indent(); }
+        ImGui::TextUnformatted(name);
+        if(indent) { ImGui::Unindent(); }
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", counter.last());
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", counter.mean());
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", counter.max());
+        ImGui::TableNextColumn();
+        counter.plot("##history");
+        ImGui::PopID();
+      };
+      row("frame", perf.frame);
+      row("update()", perf.update);
+      row("draw2D()", perf.draw2D);
+      for(const auto & cat : root_.categories) { row(cat->name.c_str(), *cat->draw_timings, true); }
+      row("draw3D()", perf.draw3D);
+      for(const auto & p : perf.plots) { row(p.first->title().c_str(), p.second); }
+      ImGui::EndTable();
+    }
+  }
+  ImGui::End();
+  if(!open) { perf_overlay(false); }
+}
 
 void Client::started()
-{ root_.started(); }
+{
+  generation_++;
+}
 
 void Client::stopped()
 {
-  root_.stopped();
+  /** Identical messages are not handled so every message that gets here changes something */
+  request_redraw();
+  /** Widgets that were not part of this message are at the back of the list */
+  while(seen_.size() && seen_.back()->generation != generation_) { remove(*seen_.back()); }
   for(auto it = active_plots_.begin(); it != active_plots_.end();)
   {
     if(!it->second->seen())
@@ -123,8 +492,16 @@ void Client::stopped()
 
 void Client::clear()
 {
+  state_hash_ = 0;
+  index_.clear();
+  seen_.clear();
   root_.categories.clear();
   root_.widgets.clear();
+  widgets3d_.clear();
+  form_widgets3d_.clear();
+  form_widgets3d_valid_ = false;
+  tree_.invalidate();
+  request_redraw();
 }
 
 void Client::enable_bold_font()
@@ -141,49 +518,88 @@ void Client::disable_bold_font()
 void Client::category(const std::vector<std::string> &, const std::string &) {}
 
 void Client::label(const ElementId & id, const std::string & txt)
-{ widget<Label>(id).data(txt); }
+{
+  auto & w = widget<Label>(id);
+  if(w.changed(txt)) { w.data(txt); }
+}
 
 void Client::array_label(const ElementId & id, const std::vector<std::string> & labels, const Eigen::VectorXd & data)
-{ widget<ArrayLabel>(id).data(labels, data); }
+{
+  auto & w = widget<ArrayLabel>(id);
+  if(w.changed(labels, data)) { w.data(labels, data); }
+}
 
 void Client::button(const ElementId & id)
 { widget<Button>(id); }
 
 void Client::checkbox(const ElementId & id, bool state)
-{ widget<Checkbox>(id).data(state); }
+{
+  auto & w = widget<Checkbox>(id);
+  if(w.changed(state)) { w.data(state); }
+}
 
 void Client::string_input(const ElementId & id, const std::string & data)
-{ widget<StringInput>(id).data(data); }
+{
+  auto & w = widget<StringInput>(id);
+  if(w.changed(data)) { w.data(data); }
+}
 
 void Client::integer_input(const ElementId & id, int data)
-{ widget<IntegerInput>(id).data(data); }
+{
+  auto & w = widget<IntegerInput>(id);
+  if(w.changed(data)) { w.data(data); }
+}
 
 void Client::number_input(const ElementId & id, double data)
-{ widget<NumberInput>(id).data(data); }
+{
+  auto & w = widget<NumberInput>(id);
+  if(w.changed(data)) { w.data(data); }
+}
 
 void Client::number_slider(const ElementId & id, double data, double min, double max)
-{ widget<NumberSlider>(id).data(data, min, max); }
+{
+  auto & w = widget<NumberSlider>(id);
+  if(w.changed(data, min, max)) { w.data(data, min, max); }
+}
 
 void Client::array_input(const ElementId & id, const std::vector<std::string> & labels, const Eigen::VectorXd & data)
-{ widget<ArrayInput>(id).data(labels, data); }
+{
+  auto & w = widget<ArrayInput>(id);
+  if(w.changed(labels, data)) { w.data(labels, data); }
+}
 
 void Client::combo_input(const ElementId & id, const std::vector<std::string> & values, const std::string & data)
-{ widget<ComboInput>(id).data(values, data); }
+{
+  auto & w = widget<ComboInput>(id);
+  if(w.changed(values, data)) { w.data(values, data); }
+}
 
 void Client::data_combo_input(const ElementId & id, const std::vector<std::string> & values, const std::string & data)
 { widget<DataComboInput>(id).data(values, data); }
 
 void Client::table_start(const ElementId & id, const std::vector<std::string> & header)
-{ widget<Table>(id).start(header); }
+{
+  MC_RTC_IMGUI_TRACE("Client::table_start");
+  widget<Table>(id).start(header);
+}
 
 void Client::table_row(const ElementId & id, const std::vector<std::string> & data)
-{ widget<Table>(id).row(data); }
+{
+  MC_RTC_IMGUI_TRACE("Client::table_row");
+  widget<Table>(id).row(data);
+}
 
 void Client::table_end(const ElementId & id)
-{ widget<Table>(id).end(); }
+{
+  MC_RTC_IMGUI_TRACE("Client::table_end");
+  widget<Table>(id).end();
+}
 
 void Client::form(const ElementId & id)
-{ active_form_ = widget<Form>(id).parentForm(); }
+{
+  MC_RTC_IMGUI_TRACE("Client::form");
+  active_form_ = widget<Form>(id).parentForm();
+}
 
 template<typename T>
 std::optional<T> null_or_default(const T & value, bool user_default)
@@ -197,28 +613,40 @@ void Client::form_checkbox(const ElementId & /*id*/,
                            bool required,
                            bool default_,
                            bool user_default)
-{ active_form_->widget<form::Checkbox>(name, required, null_or_default(default_, user_default)); }
+{
+  MC_RTC_IMGUI_TRACE("Client::form_checkbox");
+  active_form_->widget<form::Checkbox>(name, required, null_or_default(default_, user_default));
+}
 
 void Client::form_integer_input(const ElementId & /*id*/,
                                 const std::string & name,
                                 bool required,
                                 int default_,
                                 bool user_default)
-{ active_form_->widget<form::IntegerInput>(name, required, null_or_default(default_, user_default)); }
+{
+  MC_RTC_IMGUI_TRACE("Client::form_integer_input");
+  active_form_->widget<form::IntegerInput>(name, required, null_or_default(default_, user_default));
+}
 
 void Client::form_number_input(const ElementId & /*id*/,
                                const std::string & name,
                                bool required,
                                double default_,
                                bool user_default)
-{ active_form_->widget<form::NumberInput>(name, required, null_or_default(default_, user_default)); }
+{
+  MC_RTC_IMGUI_TRACE("Client::form_number_input");
+  active_form_->widget<form::NumberInput>(name, required, null_or_default(default_, user_default));
+}
 
 void Client::form_string_input(const ElementId & /*id*/,
                                const std::string & name,
                                bool required,
                                const std::string & default_,
                                bool user_default)
-{ active_form_->widget<form::StringInput>(name, required, null_or_default(default_, user_default)); }
+{
+  MC_RTC_IMGUI_TRACE("Client::form_string_input");
+  active_form_->widget<form::StringInput>(name, required, null_or_default(default_, user_default));
+}
 
 void Client::form_array_input(const ElementId & /*id*/,
                               const std::string & name,
@@ -227,7 +655,10 @@ void Client::form_array_input(const ElementId & /*id*/,
                               const Eigen::VectorXd & default_,
                               bool fixed_size,
                               bool user_default)
-{ active_form_->widget<form::ArrayInput>(name, required, labels, null_or_default(default_, user_default), fixed_size); }
+{
+  MC_RTC_IMGUI_TRACE("Client::form_array_input");
+  active_form_->widget<form::ArrayInput>(name, required, labels, null_or_default(default_, user_default), fixed_size);
+}
 
 void Client::form_point3d_input(const ElementId & /*id*/,
                                 const std::string & name,
@@ -235,7 +666,10 @@ void Client::form_point3d_input(const ElementId & /*id*/,
                                 const Eigen::Vector3d & default_,
                                 bool user_default,
                                 bool interactive)
-{ active_form_->widget<form::Point3DInput>(name, required, null_or_default(default_, user_default), interactive); }
+{
+  MC_RTC_IMGUI_TRACE("Client::form_point3d_input");
+  active_form_->widget<form::Point3DInput>(name, required, null_or_default(default_, user_default), interactive);
+}
 
 void Client::form_rotation_input(const ElementId & /*id*/,
                                  const std::string & name,
@@ -243,7 +677,10 @@ void Client::form_rotation_input(const ElementId & /*id*/,
                                  const sva::PTransformd & default_,
                                  bool user_default,
                                  bool interactive)
-{ active_form_->widget<form::RotationInput>(name, required, null_or_default(default_, user_default), interactive); }
+{
+  MC_RTC_IMGUI_TRACE("Client::form_rotation_input");
+  active_form_->widget<form::RotationInput>(name, required, null_or_default(default_, user_default), interactive);
+}
 
 void Client::form_transform_input(const ElementId & /*id*/,
                                   const std::string & name,
@@ -251,7 +688,10 @@ void Client::form_transform_input(const ElementId & /*id*/,
                                   const sva::PTransformd & default_,
                                   bool user_default,
                                   bool interactive)
-{ active_form_->widget<form::TransformInput>(name, required, null_or_default(default_, user_default), interactive); }
+{
+  MC_RTC_IMGUI_TRACE("Client::form_transform_input");
+  active_form_->widget<form::TransformInput>(name, required, null_or_default(default_, user_default), interactive);
+}
 
 void Client::form_combo_input(const ElementId & /*id*/,
                               const std::string & name,
@@ -259,26 +699,34 @@ void Client::form_combo_input(const ElementId & /*id*/,
                               const std::vector<std::string> & values,
                               bool send_index,
                               int user_default)
-{ active_form_->widget<form::ComboInput>(name, required, values, send_index, user_default); }
+{
+  MC_RTC_IMGUI_TRACE("Client::form_combo_input");
+  active_form_->widget<form::ComboInput>(name, required, values, send_index, user_default);
+}
 
 void Client::form_data_combo_input(const ElementId & /*id*/,
                                    const std::string & name,
                                    bool required,
                                    const std::vector<std::string> & ref,
                                    bool send_index)
-{ active_form_->widget<form::DataComboInput>(name, required, ref, send_index); }
+{
+  MC_RTC_IMGUI_TRACE("Client::form_data_combo_input");
+  active_form_->widget<form::DataComboInput>(name, required, ref, send_index);
+}
 
 void Client::schema(const ElementId & id, const std::string & schema)
 { widget<Schema>(id).data(schema); }
 
 void Client::start_form_object_input(const std::string & name, bool required)
 {
+  MC_RTC_IMGUI_TRACE("Client::start_form_object_input");
   require_active_form();
   active_form_ = active_form_->widget<form::ObjectWidget>(name, required, active_form_);
 }
 
 void Client::end_form_object_input()
 {
+  MC_RTC_IMGUI_TRACE("Client::end_form_object_input");
   require_active_form();
   active_form_ = active_form_->parentForm();
 }
@@ -287,12 +735,14 @@ void Client::start_form_generic_array_input(const std::string & name,
                                             bool required,
                                             std::optional<std::vector<mc_rtc::Configuration>> data)
 {
+  MC_RTC_IMGUI_TRACE("Client::start_form_generic_array_input");
   require_active_form();
   active_form_ = active_form_->widget<form::GenericArrayWidget>(name, required, required, active_form_, data);
 }
 
 void Client::end_form_generic_array_input()
 {
+  MC_RTC_IMGUI_TRACE("Client::end_form_generic_array_input");
   require_active_form();
   active_form_ = active_form_->parentForm();
 }
@@ -301,53 +751,125 @@ void Client::start_form_one_of_input(const std::string & name,
                                      bool required,
                                      const std::optional<std::pair<size_t, mc_rtc::Configuration>> & data)
 {
+  MC_RTC_IMGUI_TRACE("Client::start_form_one_of_input");
   require_active_form();
   active_form_ = active_form_->widget<form::OneOfWidget>(name, required, active_form_, data);
 }
 
 void Client::end_form_one_of_input()
 {
+  MC_RTC_IMGUI_TRACE("Client::end_form_one_of_input");
   require_active_form();
   active_form_ = active_form_->parentForm();
 }
 
 auto Client::getCategory(const std::vector<std::string> & category) -> Category &
 {
-  std::reference_wrapper<Category> out(root_);
-  for(size_t i = 0; i < category.size(); ++i)
+  if(category.empty()) { return root_; }
+  auto * out = index_.category(category);
+  if(out) { return *out; }
+  auto & parent = getCategory({category.begin(), category.end() - 1});
+  /** Categories are kept sorted by name so that they do not have to be sorted when drawn */
+  auto it = std::lower_bound(parent.categories.begin(), parent.categories.end(), category.back(),
+                             [](const auto & c, const std::string & name) { return c->name < name; });
+  auto & cat = **parent.categories.insert(it, std::make_unique<Category>(category));
+  cat.parent = &parent;
+  index_.add(cat);
+  tree_.invalidate();
+  return cat;
+}
+
+void Client::remove(Widget & w)
+{
+  auto * category = &getCategory(w.id.category);
+  seen_.erase(w.seen_it);
+  index_.remove(w);
+  auto it3d = std::find(widgets3d_.begin(), widgets3d_.end(), &w);
+  if(it3d != widgets3d_.end())
   {
-    auto & cat = out.get();
-    auto & next = category[i];
-    auto it = std::find_if(cat.categories.begin(), cat.categories.end(), [&](auto & c) { return c->name == next; });
-    if(it != cat.categories.end()) { out = std::ref(*it->get()); }
-    else
-    {
-      out = *cat.categories.emplace_back(std::make_unique<Category>(next, cat.depth + 1));
-    }
+    widgets3d_.erase(it3d);
+    form_widgets3d_valid_ = false;
+  }
+  category->widgets.erase(std::find_if(category->widgets.begin(), category->widgets.end(),
+                                       [&](const auto & wi) { return wi.get() == &w; }));
+  while(category->parent && category->empty())
+  {
+    auto * parent = category->parent;
+    index_.remove(*category);
+    tree_.invalidate();
+    parent->categories.erase(std::find_if(parent->categories.begin(), parent->categories.end(),
+                                          [&](const auto & c) { return c.get() == category; }));
+    category = parent;
   }
-  return out.get();
+}
+
+void Client::plot_history(const PlotHistory::Options & options)
+{
+  plot_history_ = options;
+  auto update = [&](Plot & plot)
+  {
+    if(!plot_history_by_title_.count(plot.title())) { plot.history_options(options); }
+  };
+  for(auto & p : active_plots_) { update(*p.second); }
+  for(auto & p : inactive_plots_) { update(*p); }
+}
+
+void Client::plot_history(const std::string & title, const PlotHistory::Options & options)
+{
+  plot_history_by_title_[title] = options;
+  for(auto & p : active_plots_)
+  {
+    if(p.second->title() == title) { p.second->history_options(options); }
+  }
+  for(auto & p : inactive_plots_)
+  {
+    if(p->title() == title) { p->history_options(options); }
+  }
+}
+
+const PlotHistory::Options & Client::plot_history(const std::string & title) const noexcept
+{
+  auto it = plot_history_by_title_.find(title);
+  return it != plot_history_by_title_.end() ? it->second : plot_history_;
+}
+
+std::shared_ptr<Plot> Client::make_plot(const std::string & title)
+{
+  auto out = std::make_shared<Plot>(title);
+  out->history_options(plot_history(title));
+  return out;
 }
 
 void Client::start_plot(uint64_t id, const std::string & title)
 {
-  if(!active_plots_.count(id)) { active_plots_[id] = std::make_shared<Plot>(title); }
+  MC_RTC_IMGUI_TRACE("Client::start_plot");
+  if(!active_plots_.count(id)) { active_plots_[id] = make_plot(title); }
   if(active_plots_[id]->title() != title)
   {
     inactive_plots_.push_back(active_plots_[id]);
     active_plots_.erase(id);
-    active_plots_[id] = std::make_shared<Plot>(title);
+    active_plots_[id] = make_plot(title);
   }
   active_plots_[id]->start_plot();
 }
 
 void Client::plot_setup_xaxis(uint64_t id, const std::string & legend, const mc_rtc::gui::plot::Range & range)
-{ active_plots_[id]->setup_xaxis(legend, range); }
+{
+  MC_RTC_IMGUI_TRACE("Client::plot_setup_xaxis");
+  active_plots_[id]->setup_xaxis(legend, range);
+}
 
 void Client::plot_setup_yaxis_left(uint64_t id, const std::string & legend, const mc_rtc::gui::plot::Range & range)
-{ active_plots_[id]->setup_yaxis_left(legend, range); }
+{
+  MC_RTC_IMGUI_TRACE("Client::plot_setup_yaxis_left");
+  active_plots_[id]->setup_yaxis_left(legend, range);
+}
 
 void Client::plot_setup_yaxis_right(uint64_t id, const std::string & legend, const mc_rtc::gui::plot::Range & range)
-{ active_plots_[id]->setup_yaxis_right(legend, range); }
+{
+  MC_RTC_IMGUI_TRACE("Client::plot_setup_yaxis_right");
+  active_plots_[id]->setup_yaxis_right(legend, range);
+}
 
 void Client::plot_point(uint64_t id,
                         uint64_t did,
@@ -357,21 +879,30 @@ void Client::plot_point(uint64_t id,
                         mc_rtc::gui::Color color,
                         mc_rtc::gui::plot::Style style,
                         mc_rtc::gui::plot::Side side)
-{ active_plots_[id]->plot_point(did, legend, x, y, color, style, side); }
+{
+  MC_RTC_IMGUI_TRACE("Client::plot_point");
+  active_plots_[id]->plot_point(did, legend, x, y, color, style, side);
+}
 
 void Client::plot_polygon(uint64_t id,
                           uint64_t did,
                           const std::string & legend,
                           const mc_rtc::gui::plot::PolygonDescription & polygon,
                           mc_rtc::gui::plot::Side side)
-{ active_plots_[id]->plot_polygon(did, legend, polygon, side); }
+{
+  MC_RTC_IMGUI_TRACE("Client::plot_polygon");
+  active_plots_[id]->plot_polygon(did, legend, polygon, side);
+}
 
 void Client::plot_polygons(uint64_t id,
                            uint64_t did,
                            const std::string & legend,
                            const std::vector<mc_rtc::gui::plot::PolygonDescription> & polygons,
                            mc_rtc::gui::plot::Side side)
-{ active_plots_[id]->plot_polygons(did, legend, polygons, side); }
+{
+  MC_RTC_IMGUI_TRACE("Client::plot_polygons");
+  active_plots_[id]->plot_polygons(did, legend, polygons, side);
+}
 
 void Client::end_plot(uint64_t) {}
 
@@ -1,8 +1,18 @@
 #pragma once
 
+#include "BufferPool.h"
 #include "Category.h"
+#include "CategoryTree.h"
+#include "Index.h"
 #include "InteractiveMarker.h"
+#include "Perf.h"
 #include "Plot.h"
+#include "Recording.h"
+#include "TripleBuffer.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 namespace mc_rtc::imgui
 {
@@ -12,6 +22,7 @@ namespace form
 
 struct ObjectWidget;
 struct OneOfWidget;
+struct Widget;
 
 } // namespace form
 
@@ -26,6 +37,20 @@ struct Client : public mc_control::ControllerClient
 
   Client(const std::string & sub_conn_uri, const std::string & push_conn_uri, double timeout = 0);
 
+  /** Tag for the offline constructor */
+  struct Offline
+  {
+  };
+
+  /** Constructs a client that is not connected to any server
+   *
+   * The GUI state must be provided by calling \ref handle_gui_state or the element callbacks directly, this is used
+   * to benchmark the client
+   */
+  explicit Client(Offline);
+
+  ~Client() override;
+
   /** Creates a new interactive marker */
   virtual InteractiveMarkerPtr make_marker(const sva::PTransformd & pose = sva::PTransformd::Identity(),
                                            ControlAxis mask = ControlAxis::NONE) = 0;
@@ -33,6 +58,106 @@ struct Client : public mc_control::ControllerClient
   /** Update the client data from the latest server message */
   void update();
 
+  /** Enable or disable the background network thread
+   *
+   * When enabled, server messages are received and decoded on a dedicated thread and \ref update() only applies
+   * the latest decoded state. This requires the client to be connected to the server through sockets.
+   */
+  void threaded(bool enable);
+
+  /** True if the background network thread is running */
+  inline bool threaded() const noexcept { return network_thread_.joinable(); }
+
+  /** Number of server messages that were received but superseded by a newer one during the last \ref update()
+   *
+   * A non-zero value means the UI is not keeping up with the server
+   */
+  inline size_t skipped_messages() const noexcept { return skipped_messages_; }
+
+  /** Total number of superseded server messages since the client was created */
+  inline uint64_t total_skipped_messages() const noexcept { return skipped_total_; }
+
+  /** Statistics about the messages received from the server, updated on every \ref update() */
+  inline const BufferPool::Stats & receive_stats() const noexcept { return receive_stats_; }
+
+  /** Allocation statistics for the widgets
+   *
+   * The pool is shared by all the clients of the process so these include the widgets of every client.
+   * heap_allocations does not change in steady state, i.e. once every widget that comes and goes was seen once
+   */
+  inline const SlabPool::Stats & widget_allocations() const noexcept { return Widget::pool().stats(); }
+
+  /** Allocation statistics for the form elements, see \ref widget_allocations() */
+  const SlabPool::Stats & form_allocations() const noexcept;
+
+  /** Show or hide the "mc_rtc perf" window
+   *
+   * The window shows rolling timings of the client and statistics about the messages received from the server, it is
+   * drawn by \ref draw2D(). Timings are only collected while the window is shown.
+   */
+  void perf_overlay(bool show);
+
+  /** True if the performance window is shown */
+  inline bool perf_overlay() const noexcept { return perf_ != nullptr; }
+
+  /** Record every message received from the server to a file, see \ref Recorder
+   *
+   * An empty path stops the recording. The recording can be fed back to a client with \ref Replay.
+   */
+  void record(const std::string & path);
+
+  /** True if the received messages are being recorded */
+  inline bool recording() const noexcept { return recording_; }
+
+  /** Handle a raw message from the server, e.g. from a recording
+   *
+   * \param latest False if a newer message is already available, only the plots are updated in that case
+   */
+  void handle_message(const char * data, size_t size, bool latest = true);
+
+  /** Handle the next state from the server even if it is identical to the last one
+   *
+   * Widgets call this through \ref Widget::invalidate() when they change their data locally so that the server state
+   * is applied again if the server ignores the request
+   */
+  inline void invalidate_state() noexcept { state_hash_ = 0; }
+
+  /** True if the GUI changed since the last frames drawn by \ref draw2D()
+   *
+   * This is the case after \ref update() handled a message that changed the GUI state, while the user interacts with
+   * a widget and for a few frames after that so that ImGui can settle its layout. Host applications can skip
+   * rendering or lower their frame rate while this is false, they should still render when they receive input events.
+   */
+  inline bool redraw_needed() const noexcept { return redraw_frames_ > 0; }
+
+  /** Request a redraw, implementations should call this when something they draw changes outside of \ref update() */
+  inline void request_redraw() noexcept { redraw_frames_ = redraw_settle_frames; }
+
+  /** Bounds and storage of the history kept for the lines of every plot, plots with their own options are not
+   * affected */
+  void plot_history(const PlotHistory::Options & options);
+
+  /** Bounds and storage of the history kept for the lines of the plots with the given title */
+  void plot_history(const std::string & title, const PlotHistory::Options & options);
+
+  /** Bounds and storage of the history kept for the lines of the plots with the given title */
+  const PlotHistory::Options & plot_history(const std::string & title) const noexcept;
+
+  /** Navigation between the categories in the "mc_rtc" window */
+  enum class Navigation
+  {
+    /** Nested tab bars, this is the default */
+    Tabs,
+    /** Tree of the categories next to the widgets of the selected category, suited to large category trees */
+    Tree
+  };
+
+  /** Select how the categories are navigated */
+  inline void navigation(Navigation navigation) noexcept { navigation_ = navigation; }
+
+  /** Current navigation mode */
+  inline Navigation navigation() const noexcept { return navigation_; }
+
   /** Draw ImGui elements */
   void draw2D(ImVec2 windowSize);
 
@@ -51,9 +176,96 @@ struct Client : public mc_control::ControllerClient
   void disable_bold_font();
 
 protected:
-  std::vector<char> buffer_ = std::vector<char>(65535);
+  /** Receive buffers, only used by the thread receiving the messages */
+  BufferPool buffers_;
+  /** See \ref receive_stats() */
+  BufferPool::Stats receive_stats_;
   std::chrono::system_clock::time_point t_last_ = std::chrono::system_clock::now();
 
+  /** GUI states decoded by the network thread since the last consumed batch, the latest comes last */
+  struct StateBatch
+  {
+    std::vector<mc_rtc::Configuration> states;
+    BufferPool::Stats stats;
+  };
+  /** Batches published by the network thread */
+  TripleBuffer<StateBatch> states_;
+  /** Maximum number of states in a batch, older states are dropped beyond that */
+  static constexpr size_t max_pending_states = 256;
+  /** Receive and decode thread, see \ref threaded() */
+  std::thread network_thread_;
+  std::atomic<bool> network_run_{false};
+  /** Last time the network thread received a message */
+  std::atomic<std::chrono::system_clock::time_point> last_received_{std::chrono::system_clock::now()};
+
+  /** Hash of the last state applied, identical states are not handled again */
+  std::atomic<uint64_t> state_hash_{0};
+
+  /** Body of the network thread */
+  void network_loop();
+
+  /** Records the received messages, see \ref record() */
+  std::unique_ptr<Recorder> recorder_;
+  /** Protects recorder_ which is used by the thread receiving the messages */
+  std::mutex recorder_mutex_;
+  std::atomic<bool> recording_{false};
+
+  /** Timings and statistics shown in the performance window */
+  struct PerfData
+  {
+    PerfCounter update;
+    PerfCounter draw2D;
+    PerfCounter draw3D;
+    /** Time between two frames */
+    PerfCounter frame;
+    /** Messages received during each frame */
+    PerfCounter messages;
+    /** Size of the last message received at each frame (kiB) */
+    PerfCounter message_size;
+    /** do_plot() timings for each plot */
+    std::unordered_map<const Plot *, PerfCounter> plots;
+    uint64_t last_messages = 0;
+    std::chrono::steady_clock::time_point last_frame = std::chrono::steady_clock::now();
+  };
+  /** Null unless the performance window is shown */
+  std::unique_ptr<PerfData> perf_;
+
+  /** Draw the performance window */
+  void draw_perf_overlay();
+
+  /** Timings for a plot, null if the performance window is hidden */
+  inline PerfCounter * plot_timings(const Plot * plot) { return perf_ ? &perf_->plots[plot] : nullptr; }
+
+  /** Receive a message from the server into a buffer from buffers_
+   *
+   * \returns The message size, 0 if the message did not fit in the buffer (the buffer is then resized) or a negative
+   * value if no message was received
+   */
+  int receive(BufferPool::Buffer & buffer, int flags);
+
+  /** Remove every element if no message was received for longer than the timeout */
+  void check_timeout();
+
+  /** Number of frames drawn after a change by \ref redraw_needed() */
+  static constexpr int redraw_settle_frames = 3;
+  /** Frames that still have to be drawn, see \ref redraw_needed() */
+  int redraw_frames_ = redraw_settle_frames;
+
+  /** See \ref skipped_messages() */
+  size_t skipped_messages_ = 0;
+  /** See \ref total_skipped_messages() */
+  std::atomic<uint64_t> skipped_total_{0};
+
+  /** Forwards the plot callbacks of skipped states to the client, see \ref handle_skipped_state */
+  struct PlotReplay;
+  std::unique_ptr<PlotReplay> plot_replay_;
+
+  /** Handle a state superseded by a newer one, only plots are updated */
+  void handle_skipped_state(const char * data, size_t size);
+
+  /** Handle a state superseded by a newer one, only plots are updated */
+  void handle_skipped_state(const mc_rtc::Configuration & state);
+
   /** No message for unsupported types */
   void default_impl(const std::string &, const ElementId &) final {}
 
@@ -214,6 +426,40 @@ protected:
 
   Category root_;
 
+  /** Index of all categories and widgets in root_ */
+  Index index_;
+
+  /** See \ref navigation() */
+  Navigation navigation_ = Navigation::Tabs;
+
+  /** Tree view used when navigation_ is Navigation::Tree */
+  CategoryTree tree_;
+
+  /** Generation of the current server message, incremented in started() */
+  uint64_t generation_ = 0;
+
+  /** All widgets ordered by generation, most recently seen first */
+  std::list<Widget *> seen_;
+
+  /** Mark a widget as seen in the current message */
+  inline void seen(Widget & w)
+  {
+    w.generation = generation_;
+    seen_.splice(seen_.begin(), seen_, w.seen_it);
+  }
+
+  /** Remove a widget, its category and parents are removed as well if they become empty */
+  void remove(Widget & w);
+
+  /** Widgets with 3D content, see \ref Widget::has_3d */
+  std::vector<Widget *> widgets3d_;
+  /** Form elements with 3D content collected from widgets3d_ */
+  std::vector<form::Widget *> form_widgets3d_;
+  /** False when form_widgets3d_ must be collected again */
+  bool form_widgets3d_valid_ = false;
+  /** Value of form::Widget::structure_version() when form_widgets3d_ was collected */
+  uint64_t form_widgets3d_version_ = 0;
+
   /** Returns a category (creates it if it does not exist */
   Category & getCategory(const std::vector<std::string> & category);
 
@@ -232,6 +478,15 @@ protected:
   /** Currently inactive plots */
   std::vector<std::shared_ptr<Plot>> inactive_plots_;
 
+  /** See \ref plot_history() */
+  PlotHistory::Options plot_history_;
+
+  /** Plot history options set for a specific plot title */
+  std::unordered_map<std::string, PlotHistory::Options> plot_history_by_title_;
+
+  /** Create a plot with the history options set for its title */
+  std::shared_ptr<Plot> make_plot(const std::string & title);
+
   /** Bold font, default font if unset */
   ImFont * bold_font_ = nullptr;
 
@@ -239,27 +494,26 @@ protected:
   template<typename T, typename... Args>
   T & widget(const ElementId & id, Args &&... args)
   {
-    auto & category = getCategory(id.category);
-    auto it =
-        std::find_if(category.widgets.begin(), category.widgets.end(), [&](auto & w) { return w->id.name == id.name; });
-    if(it == category.widgets.end())
+    auto * w = index_.widget(id);
+    if(w && w->type == widget_type<T>())
     {
-      auto & w = category.widgets.emplace_back(std::make_unique<T>(*this, id, std::forward<Args>(args)...));
-      w->seen = true;
-      return *dynamic_cast<T *>(w.get());
+      seen(*w);
+      return *static_cast<T *>(w);
     }
-    else
+    /** Different type, remove and add the widget again */
+    if(w) { remove(*w); }
+    auto & category = getCategory(id.category);
+    auto & out = category.widgets.emplace_back(std::make_unique<T>(*this, id, std::forward<Args>(args)...));
+    out->type = widget_type<T>();
+    out->generation = generation_;
+    out->seen_it = seen_.insert(seen_.begin(), out.get());
+    index_.add(*out);
+    if constexpr(Widget::has_3d<T>())
     {
-      auto w_ptr = dynamic_cast<T *>(it->get());
-      if(w_ptr)
-      {
-        w_ptr->seen = true;
-        return *w_ptr;
-      }
-      /** Different type, remove and add the widget again */
-      category.widgets.erase(it);
-      return widget<T>(id, std::forward<Args>(args)...);
+      widgets3d_.push_back(out.get());
+      form_widgets3d_valid_ = false;
     }
+    return *static_cast<T *>(out.get());
   }
 };
 
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <Eigen/Core>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace mc_rtc::imgui
+{
+
+/** Fast non-cryptographic hash used to detect changes in the data received from the server */
+struct Hash
+{
+  inline Hash & bytes(const void * data, size_t size) noexcept
+  {
+    auto * ptr = static_cast<const unsigned char *>(data);
+    mix(size);
+    for(; size >= 8; size -= 8, ptr += 8)
+    {
+      uint64_t word;
+      std::memcpy(&word, ptr, 8);
+      mix(word);
+    }
+    uint64_t word = 0;
+    std::memcpy(&word, ptr, size);
+    mix(word);
+    return *this;
+  }
+
+  template<typename T>
+  inline Hash & add(const T & value) noexcept
+  {
+    if constexpr(std::is_arithmetic_v<T>) { return bytes(&value, sizeof(T)); }
+    else if constexpr(std::is_same_v<T, std::string>) { return bytes(value.data(), value.size()); }
+    else if constexpr(std::is_same_v<T, Eigen::VectorXd>)
+    {
+      return bytes(value.data(), static_cast<size_t>(value.size()) * sizeof(double));
+    }
+    else
+    {
+      mix(value.size());
+      for(const auto & v : value) { add(v); }
+      return *this;
+    }
+  }
+
+  inline uint64_t value() const noexcept { return h_ ^ (h_ >> 29); }
+
+private:
+  uint64_t h_ = 0xcbf29ce484222325ull;
+
+  inline void mix(uint64_t word) noexcept
+  {
+    h_ = (h_ ^ word) * 0x100000001b3ull;
+    h_ ^= h_ >> 32;
+  }
+};
+
+/** Hash of a list of values */
+template<typename... Args>
+inline uint64_t hash(const Args &... args) noexcept
+{
+  Hash out;
+  (out.add(args), ...);
+  return out.value();
+}
+
+} // namespace mc_rtc::imgui
@@ -0,0 +1,75 @@
+#include "Index.h"
+
+#include "Category.h"
+
+namespace mc_rtc::imgui
+{
+
+namespace
+{
+
+inline void hash_combine(size_t & seed, size_t h) noexcept
+{ seed ^= h + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2); }
+
+/** Insert or replace, a replaced entry must not keep its key that points into the previous object */
+template<typename MapT, typename KeyT, typename ValueT>
+void replace(MapT & map, const KeyT & key, ValueT * value)
+{
+  auto it = map.find(key);
+  if(it != map.end()) { map.erase(it); }
+  map.emplace(key, value);
+}
+
+} // namespace
+
+size_t Index::Hash::operator()(CategoryKey key) const noexcept
+{
+  size_t out = key->size();
+  for(const auto & c : *key) { hash_combine(out, std::hash<std::string>{}(c)); }
+  return out;
+}
+
+size_t Index::Hash::operator()(const WidgetKey & key) const noexcept
+{
+  size_t out = (*this)(key.first);
+  hash_combine(out, std::hash<std::string>{}(*key.second));
+  return out;
+}
+
+Category * Index::category(const std::vector<std::string> & path) const noexcept
+{
+  auto it = categories_.find(&path);
+  return it != categories_.end() ? it->second : nullptr;
+}
+
+Widget * Index::widget(const ElementId & id) const noexcept
+{
+  auto it = widgets_.find({&id.category, &id.name});
+  return it != widgets_.end() ? it->second : nullptr;
+}
+
+void Index::add(Category & category)
+{ replace(categories_, &category.path, &category); }
+
+void Index::add(Widget & widget)
+{ replace(widgets_, WidgetKey{&widget.id.category, &widget.id.name}, &widget); }
+
+void Index::remove(const Category & category)
+{
+  auto it = categories_.find(&category.path);
+  if(it != categories_.end() && it->second == &category) { categories_.erase(it); }
+}
+
+void Index::remove(const Widget & widget)
+{
+  auto it = widgets_.find({&widget.id.category, &widget.id.name});
+  if(it != widgets_.end() && it->second == &widget) { widgets_.erase(it); }
+}
+
+void Index::clear()
+{
+  categories_.clear();
+  widgets_.clear();
+}
+
+} // namespace mc_rtc::imgui
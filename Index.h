@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Widget.h"
+
+#include <unordered_map>
+
+namespace mc_rtc::imgui
+{
+
+struct Category;
+
+/** Index of the categories and widgets in the GUI tree
+ *
+ * Categories are indexed by their full path and widgets by their (category, name) pair so that the client can
+ * retrieve them in constant time when handling a server message.
+ *
+ * The keys are non-owning views into the indexed objects' own path/id, hence an object must be removed from the
+ * index before it is destroyed.
+ */
+struct Index
+{
+  /** Returns the category at the given path, nullptr if it is not indexed */
+  Category * category(const std::vector<std::string> & path) const noexcept;
+
+  /** Returns the widget with the given id, nullptr if it is not indexed */
+  Widget * widget(const ElementId & id) const noexcept;
+
+  void add(Category & category);
+
+  void add(Widget & widget);
+
+  void remove(const Category & category);
+
+  void remove(const Widget & widget);
+
+  void clear();
+
+private:
+  using CategoryKey = const std::vector<std::string> *;
+
+  using WidgetKey = std::pair<const std::vector<std::string> *, const std::string *>;
+
+  struct Hash
+  {
+    size_t operator()(CategoryKey key) const noexcept;
+    size_t operator()(const WidgetKey & key) const noexcept;
+  };
+
+  struct Equal
+  {
+    inline bool operator()(CategoryKey lhs, CategoryKey rhs) const noexcept { return *lhs == *rhs; }
+    inline bool operator()(const WidgetKey & lhs, const WidgetKey & rhs) const noexcept
+    { return *lhs.second == *rhs.second && *lhs.first == *rhs.first; }
+  };
+
+  std::unordered_map<CategoryKey, Category *, Hash, Equal> categories_;
+  std::unordered_map<WidgetKey, Widget *, Hash, Equal> widgets_;
+};
+
+} // namespace mc_rtc::imgui
@@ -0,0 +1,43 @@
+#pragma once
+
+#ifdef SPDLOG_FMT_EXTERNAL
+#  include <fmt/format.h>
+#else
+#  include <spdlog/fmt/bundled/format.h>
+#endif
+
+#include <algorithm>
+#include <string_view>
+
+namespace mc_rtc::imgui
+{
+
+/** An ImGui label built in a fixed-size buffer
+ *
+ * The label is "{label}##{id...}", the visible part is truncated if it is too long but the id part is always kept.
+ * This is used instead of formatting a std::string so that drawing labels does not allocate.
+ */
+struct LabelBuffer
+{
+  static constexpr size_t SIZE = 256;
+
+  /** Maximum size of the visible part */
+  static constexpr size_t MAX_LABEL_SIZE = SIZE - 64;
+
+  template<typename... Args>
+  inline LabelBuffer(std::string_view label, const Args &... id)
+  {
+    auto end = std::copy_n(label.data(), std::min(label.size(), MAX_LABEL_SIZE), data_);
+    *end++ = '#';
+    *end++ = '#';
+    ((end = fmt::format_to_n(end, static_cast<size_t>(data_ + SIZE - 1 - end), "{}", id).out), ...);
+    *end = 0;
+  }
+
+  inline const char * c_str() const noexcept { return data_; }
+
+private:
+  char data_[SIZE];
+};
+
+} // namespace mc_rtc::imgui
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <chrono>
+
+namespace mc_rtc::imgui
+{
+
+/** Fixed-size history of a measurement, used by the performance overlay */
+struct PerfCounter
+{
+  /** Number of samples kept */
+  static constexpr size_t SIZE = 120;
+
+  inline void add(float value) noexcept
+  {
+    values_[offset_] = value;
+    offset_ = (offset_ + 1) % SIZE;
+    count_ = std::min(count_ + 1, SIZE);
+  }
+
+  inline float last() const noexcept { return count_ ? values_[(offset_ + SIZE - 1) % SIZE] : 0.0f; }
+
+  inline float sum() const noexcept
+  {
+    float out = 0.0f;
+    for(size_t i = 0; i < count_; ++i) { out += values_[i]; }
+    return out;
+  }
+
+  inline float mean() const noexcept { return count_ ? sum() / static_cast<float>(count_) : 0.0f; }
+
+  inline float max() const noexcept
+  { return count_ ? *std::max_element(values_.begin(), values_.begin() + static_cast<long>(count_)) : 0.0f; }
+
+  /** Plot the history, oldest sample on the left */
+  inline void plot(const char * label) const
+  {
+    ImGui::PlotLines(label, values_.data(), static_cast<int>(SIZE), static_cast<int>(offset_), nullptr, 0.0f,
+                     FLT_MAX, ImVec2(ImGui::GetContentRegionAvail().x, 0.0f));
+  }
+
+private:
+  std::array<float, SIZE> values_ = {};
+  size_t offset_ = 0;
+  size_t count_ = 0;
+};
+
+/** Adds the time spent in a scope to a counter (in ms), does nothing if the counter is null */
+struct ScopedTimer
+{
+  using clock = std::chrono::steady_clock;
+
+  inline ScopedTimer(PerfCounter * counter) noexcept : counter_(counter)
+  {
+    if(counter_) { start_ = clock::now(); }
+  }
+
+  inline ~ScopedTimer()
+  {
+    if(counter_) { counter_->add(std::chrono::duration<float, std::milli>(clock::now() - start_).count()); }
+  }
+
+  ScopedTimer(const ScopedTimer &) = delete;
+  ScopedTimer & operator=(const ScopedTimer &) = delete;
+
+private:
+  PerfCounter * counter_;
+  clock::time_point start_;
+};
+
+} // namespace mc_rtc::imgui
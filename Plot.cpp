@@ -1,7 +1,13 @@
 #include "Plot.h"
 
+#include "LabelBuffer.h"
+#include "Trace.h"
+
 #include "implot_internal.h"
 
+#include <algorithm>
+#include <limits>
+
 namespace mc_rtc::imgui
 {
 
@@ -24,12 +30,62 @@ inline void range_to_limits(const mc_rtc::gui::plot::Range & range,
   }
 }
 
+/** Padding added around the data when the axes fit the data, as a fraction of the data range */
+constexpr double fit_padding = 0.1;
+
+/** Range that contains nothing, see fit() */
+inline ImPlotRange empty_range() noexcept
+{ return {std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()}; }
+
+/** Extend range to contain [min, max] */
+inline void fit(ImPlotRange & range, double min, double max) noexcept
+{
+  range.Min = std::min(range.Min, min);
+  range.Max = std::max(range.Max, max);
+}
+
+/** Extend x and y to contain the points of a polygon */
+inline void fit(ImPlotRange & x, ImPlotRange & y, const mc_rtc::gui::plot::PolygonDescription & polygon) noexcept
+{
+  for(const auto & p : polygon.points())
+  {
+    fit(x, p[0], p[0]);
+    fit(y, p[1], p[1]);
+  }
+}
+
+/** Set the limits of an axis, either the limits provided by the server or the padded extents of the data if the axis
+ * follows the data, the limits are left to the user otherwise */
+inline void setup_limits(ImAxis axis, const Plot::AxisLimits & limits, const ImPlotRange & extents, bool follow)
+{
+  if(limits) { ImPlot::SetupAxisLimits(axis, limits->first, limits->second, ImGuiCond_Always); }
+  else if(follow && extents.Min <= extents.Max)
+  {
+    /** Same as ImPlot fit: padding on each side and a unit range around a single value */
+    double padding = 0.5 * fit_padding * (extents.Max - extents.Min);
+    double min = extents.Min - padding;
+    double max = extents.Max + padding;
+    if(min == max)
+    {
+      min -= 0.5;
+      max += 0.5;
+    }
+    ImPlot::SetupAxisLimits(axis, min, max, ImGuiCond_Always);
+  }
+}
+
 } // namespace
 
 uint64_t Plot::UID = 0;
 
 Plot::Plot(const std::string & title) : uid_(UID++), title_(title) {}
 
+void Plot::history_options(const PlotHistory::Options & options)
+{
+  history_options_ = options;
+  for(auto & p : plots_) { p.second.points.options(options); }
+}
+
 void Plot::setup_xaxis(const std::string & label, const mc_rtc::gui::plot::Range & range)
 {
   x_label_ = label;
@@ -61,7 +117,7 @@ void Plot::plot_point(uint64_t did,
     if(!plots_.count(did))
     {
       plots_[did] = {};
-      plots_[did].points.reserve(1024);
+      plots_[did].points.options(history_options_);
     }
     return plots_[did];
   };
@@ -70,7 +126,7 @@ void Plot::plot_point(uint64_t did,
   plot.color = color;
   plot.style = style;
   plot.side = side;
-  plot.points.push_back({x, y});
+  plot.points.push(x, y);
   side == Side::Left ? y_plots_++ : y2_plots_++;
 }
 
@@ -79,8 +135,15 @@ void Plot::plot_polygon(uint64_t did,
                         const mc_rtc::gui::plot::PolygonDescription & polygon,
                         mc_rtc::gui::plot::Side side)
 {
+  bool created = !polygons_.count(did);
   auto & poly = polygons_[did];
-  if(poly.polygon != polygon) { poly.polygon = polygon; }
+  if(created || poly.polygon != polygon)
+  {
+    poly.polygon = polygon;
+    poly.x_extents = empty_range();
+    poly.y_extents = empty_range();
+    fit(poly.x_extents, poly.y_extents, polygon);
+  }
   poly.label = label;
   poly.side = side;
   side == Side::Left ? y_plots_++ : y2_plots_++;
@@ -91,8 +154,15 @@ void Plot::plot_polygons(uint64_t did,
                          const std::vector<mc_rtc::gui::plot::PolygonDescription> & polygons,
                          mc_rtc::gui::plot::Side side)
 {
+  bool created = !polygonGroups_.count(did);
   auto & group = polygonGroups_[did];
-  if(group.polygons != polygons) { group.polygons = polygons; }
+  if(created || group.polygons != polygons)
+  {
+    group.polygons = polygons;
+    group.x_extents = empty_range();
+    group.y_extents = empty_range();
+    for(const auto & polygon : polygons) { fit(group.x_extents, group.y_extents, polygon); }
+  }
   group.label = label;
   group.side = side;
   side == Side::Left ? y_plots_++ : y2_plots_++;
@@ -100,9 +170,13 @@ void Plot::plot_polygons(uint64_t did,
 
 void Plot::do_plot()
 {
-  ImPlotAxisFlags x_flags = ImPlotAxisFlags_AutoFit;
-  ImPlotAxisFlags y_flags = ImPlotAxisFlags_AutoFit;
-  ImPlotAxisFlags y2_flags = ImPlotAxisFlags_AutoFit | ImPlotAxisFlags_Opposite;
+  MC_RTC_IMGUI_TRACE("Plot::do_plot");
+  /** The axes fit the data through the extents maintained for each line and polygon, ImPlot's own fit would go through
+   * every point of every line each frame. They stop following the data when the user zooms or pans and follow it
+   * again after a double click (ImPlot fit). */
+  ImPlotAxisFlags x_flags = ImPlotAxisFlags_None;
+  ImPlotAxisFlags y_flags = ImPlotAxisFlags_None;
+  ImPlotAxisFlags y2_flags = ImPlotAxisFlags_Opposite;
   const char * y_label = y_label_.c_str();
   if(y_plots_ == 0)
   {
@@ -119,14 +193,33 @@ void Plot::do_plot()
     y2_flags = ImPlotAxisFlags_NoDecorations;
     y2_label = nullptr;
   }
-  bool do_ = ImPlot::BeginPlot(fmt::format("{}##{}", title_, uid_).c_str(), ImVec2{-1, 0}, ImPlotFlags_YAxis2);
+  x_range_ = empty_range();
+  y_range_ = empty_range();
+  y2_range_ = empty_range();
+  for(const auto & pp : plots_)
+  {
+    const auto & extents = pp.second.points.extents();
+    fit(x_range_, extents.x_min, extents.x_max);
+    fit(pp.second.side == Side::Left ? y_range_ : y2_range_, extents.y_min, extents.y_max);
+  }
+  for(const auto & pp : polygons_)
+  {
+    fit(x_range_, pp.second.x_extents.Min, pp.second.x_extents.Max);
+    fit(pp.second.side == Side::Left ? y_range_ : y2_range_, pp.second.y_extents.Min, pp.second.y_extents.Max);
+  }
+  for(const auto & pp : polygonGroups_)
+  {
+    fit(x_range_, pp.second.x_extents.Min, pp.second.x_extents.Max);
+    fit(pp.second.side == Side::Left ? y_range_ : y2_range_, pp.second.y_extents.Min, pp.second.y_extents.Max);
+  }
+  bool do_ = ImPlot::BeginPlot(LabelBuffer(title_, uid_).c_str(), ImVec2{-1, 0}, ImPlotFlags_YAxis2);
   if(!do_) { return; }
   ImPlot::SetupAxis(ImAxis_X1, x_label_.c_str(), x_flags);
   if(y_plots_ != 0) { ImPlot::SetupAxis(ImAxis_Y1, y_label, y_flags); }
   if(y2_plots_ != 0) { ImPlot::SetupAxis(ImAxis_Y2, y2_label, y2_flags); }
-  if(x_limits_) { ImPlot::SetupAxisLimits(ImAxis_X1, x_limits_->first, x_limits_->second, ImGuiCond_Always); }
-  if(y_limits_) { ImPlot::SetupAxisLimits(ImAxis_Y1, y_limits_->first, y_limits_->second, ImGuiCond_Always); }
-  if(y2_limits_) { ImPlot::SetupAxisLimits(ImAxis_Y2, y2_limits_->first, y2_limits_->second, ImGuiCond_Always); }
+  setup_limits(ImAxis_X1, x_limits_, x_range_, follow_);
+  setup_limits(ImAxis_Y1, y_limits_, y_range_, follow_);
+  setup_limits(ImAxis_Y2, y2_limits_, y2_range_, follow_);
   auto toImVec4 = [](const Color & color)
   {
     return ImVec4{static_cast<float>(color.r), static_cast<float>(color.g), static_cast<float>(color.b),
@@ -137,7 +230,8 @@ void Plot::do_plot()
     return ImGui::ColorConvertFloat4ToU32({static_cast<float>(color.r), static_cast<float>(color.g),
                                            static_cast<float>(color.b), static_cast<float>(color.a)});
   };
-  ImPlot::PushStyleVar(ImPlotStyleVar_FitPadding, ImVec2{0.1f, 0.1f});
+  ImPlot::PushStyleVar(ImPlotStyleVar_FitPadding,
+                       ImVec2{static_cast<float>(fit_padding), static_cast<float>(fit_padding)});
   auto plot_poly = [this, &toImU32](const PolygonDescription & poly, Side side)
   {
     auto * draw_list = ImPlot::GetPlotDrawList();
@@ -151,6 +245,7 @@ void Plot::do_plot()
     for(size_t i = 0; i < poly.points().size(); ++i)
     {
       points_[i] = ImPlot::PlotToPixels(poly.points()[i][0], poly.points()[i][1]);
+      /** Only when the user asks ImPlot to fit the data, the polygon extents are used otherwise */
       if(ImPlot::FitThisFrame()) { ImPlot::FitPoint({poly.points()[i][0], poly.points()[i][1]}); }
     }
     if(fillColor.a != 0.0) { draw_list->AddConvexPolyFilled(points_.data(), points_.size(), toImU32(fillColor)); }
@@ -174,19 +269,57 @@ void Plot::do_plot()
       ImPlot::EndItem();
     }
   }
-  for(const auto & pp : plots_)
+  auto pixels = static_cast<size_t>(std::max(ImPlot::GetPlotSize().x, 1.0f));
+  /** Only the visible part of the lines is decimated, except when ImPlot fits the axes to the items of this frame */
+  auto x_visible = ImPlot::GetPlotLimits().X;
+  bool fit_items = ImPlot::FitThisFrame();
+  if(fit_items) { follow_ = true; }
+  else if(follow_ && (ImPlot::IsPlotHovered() || ImPlot::IsAxisHovered(ImAxis_X1) || ImPlot::IsAxisHovered(ImAxis_Y1)
+                      || ImPlot::IsAxisHovered(ImAxis_Y2)))
   {
-    const auto & p = pp.second;
+    /** The axes follow the data until the user zooms or pans, the limits are locked this frame so the interaction
+     * takes effect from the next one */
+    const auto & io = ImGui::GetIO();
+    follow_ = !(ImGui::IsMouseDragging(ImGuiMouseButton_Left) || ImGui::IsMouseDragging(ImGuiMouseButton_Right)
+                || io.MouseWheel != 0.0f || io.MouseWheelH != 0.0f);
+  }
+  for(auto & pp : plots_)
+  {
+    auto & p = pp.second;
     ImPlot::SetAxis(p.side == Side::Left ? ImAxis_Y1 : ImAxis_Y2);
+    /** The history is a ring buffer, ImPlot starts from the oldest sample at the offset and wraps around */
+    const double * xs = p.points.xs();
+    const double * ys = p.points.ys();
+    auto count = static_cast<int>(p.points.size());
+    auto offset = static_cast<int>(p.points.offset());
+    int stride = sizeof(double);
+    /** Lines with many more samples than pixels are reduced to about two samples per pixel, a compact history is
+     * always reduced since ImPlot cannot read it (it is sorted, see PlotHistory::options) */
+    if(!p.points.empty() && (p.points.size() > 4 * pixels || !p.points.contiguous()) && p.points.sorted())
+    {
+      Decimation decimation{p.points.version(), fit_items ? p.points.front().x : x_visible.Min,
+                            fit_items ? p.points.back().x : x_visible.Max, pixels};
+      if(!(decimation == p.decimation))
+      {
+        MC_RTC_IMGUI_TRACE("Plot::decimate");
+        p.points.decimate(decimation.x_min, decimation.x_max, pixels, p.decimated);
+        p.decimation = decimation;
+      }
+      xs = p.decimated.size() ? &p.decimated[0].x : xs;
+      ys = p.decimated.size() ? &p.decimated[0].y : ys;
+      count = static_cast<int>(p.decimated.size());
+      offset = 0;
+      stride = sizeof(PlotHistory::Point);
+    }
     if(p.style == Style::Point)
     {
       ImPlot::SetNextLineStyle({0, 0, 0, 0});
-      ImPlot::PlotLine(p.label.c_str(), &p.points[0].x, &p.points[0].y, p.points.size(), 0, sizeof(Point));
+      ImPlot::PlotLine(p.label.c_str(), xs, ys, count, offset, stride);
       if(ImPlot::BeginItem(p.label.c_str()))
       {
         ImPlot::GetCurrentItem()->Color = toImU32(p.color);
         auto * draw_list = ImPlot::GetPlotDrawList();
-        auto & point = p.points[p.points.size() - 1];
+        auto point = p.points.back();
         auto ppoint = ImPlot::PlotToPixels(point.x, point.y);
         draw_list->AddCircleFilled(ppoint, 4.0f, toImU32(p.color));
         ImPlot::EndItem();
@@ -196,15 +329,9 @@ void Plot::do_plot()
     {
       // FIXME We can not plot dashed and dotted lines yet
       ImPlot::SetNextLineStyle(toImVec4(p.color));
-      ImPlot::PlotLine(p.label.c_str(), &p.points[0].x, &p.points[0].y, p.points.size(), 0, sizeof(Point));
+      ImPlot::PlotLine(p.label.c_str(), xs, ys, count, offset, stride);
     }
   }
-  {
-    auto ctx = ImPlot::GetCurrentContext();
-    x_range_ = ctx->CurrentPlot->Axes[ImAxis_X1].FitExtents;
-    y_range_ = ctx->CurrentPlot->Axes[ImAxis_Y1].FitExtents;
-    y2_range_ = ctx->CurrentPlot->Axes[ImAxis_Y2].FitExtents;
-  }
   ImPlot::EndPlot();
 }
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "PlotHistory.h"
+
 #include "implot.h"
 
 #include <mc_rtc/gui/plot/types.h>
@@ -24,6 +26,11 @@ struct Plot
 
   inline const std::string & title() const noexcept { return title_; }
 
+  /** Bounds and storage of the history kept for each line of the plot */
+  void history_options(const PlotHistory::Options & options);
+
+  inline const PlotHistory::Options & history_options() const noexcept { return history_options_; }
+
   inline void start_plot() noexcept
   {
     seen_ = true;
@@ -79,16 +86,32 @@ private:
   ImPlotRange y_range_;
   ImPlotRange y2_range_;
   bool seen_ = false;
+  /** True while the axes without limits from the server fit the data, see \ref do_plot */
+  bool follow_ = true;
   uint64_t y_plots_ = 0;
   uint64_t y2_plots_ = 0;
-  struct Point
+  PlotHistory::Options history_options_;
+  /** Parameters of the last decimation of a line, see \ref PlotHistory::decimate */
+  struct Decimation
   {
-    double x;
-    double y;
+    uint64_t version = 0;
+    double x_min = 0.0;
+    double x_max = 0.0;
+    size_t pixels = 0;
+
+    inline bool operator==(const Decimation & rhs) const noexcept
+    {
+      return version == rhs.version && x_min == rhs.x_min && x_max == rhs.x_max && pixels == rhs.pixels;
+    }
   };
   struct PlotLine
   {
-    std::vector<Point> points;
+    PlotHistory points;
+    /** Decimated samples, only used if the line has many more samples than the plot has pixels or if the
+     * history is not contiguous */
+    std::vector<PlotHistory::Point> decimated;
+    /** Decimated is only computed again when this changes */
+    Decimation decimation;
     std::string label;
     Color color;
     Side side;
@@ -99,12 +122,18 @@ private:
     PolygonDescription polygon;
     std::string label;
     Side side;
+    /** Extents of the polygon, computed when it changes */
+    ImPlotRange x_extents;
+    ImPlotRange y_extents;
   };
   struct PolygonGroup
   {
     std::vector<PolygonDescription> polygons;
     std::string label;
     Side side;
+    /** Extents of the polygons, computed when they change */
+    ImPlotRange x_extents;
+    ImPlotRange y_extents;
   };
   std::unordered_map<uint64_t, PlotLine> plots_;
   std::unordered_map<uint64_t, Polygon> polygons_;
@@ -0,0 +1,535 @@
+#include "PlotHistory.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace mc_rtc::imgui
+{
+
+namespace
+{
+
+/** Keeps the extremes of each bucket of a sequence of samples sorted by x, see PlotHistory::decimate */
+struct Reducer
+{
+  using Point = PlotHistory::Point;
+
+  Reducer(double x_min, double x_max, size_t buckets, std::vector<Point> & out)
+  : x_min_(x_min), scale_(x_max > x_min ? static_cast<double>(buckets) / (x_max - x_min) : 0.0), buckets_(buckets),
+    bucket_(buckets), out_(out)
+  {
+  }
+
+  void add(const Point & p)
+  {
+    auto b = std::min(static_cast<size_t>(std::max(p.x - x_min_, 0.0) * scale_), buckets_ - 1);
+    if(b != bucket_)
+    {
+      flush();
+      bucket_ = b;
+      min_ = p;
+      max_ = p;
+      min_first_ = true;
+    }
+    else if(p.y < min_.y)
+    {
+      min_ = p;
+      min_first_ = false;
+    }
+    else if(p.y > max_.y)
+    {
+      max_ = p;
+      min_first_ = true;
+    }
+  }
+
+  void flush()
+  {
+    if(bucket_ == buckets_) { return; }
+    const auto & first = min_first_ ? min_ : max_;
+    const auto & second = min_first_ ? max_ : min_;
+    out_.push_back(first);
+    if(second.x != first.x || second.y != first.y) { out_.push_back(second); }
+  }
+
+private:
+  double x_min_;
+  double scale_;
+  size_t buckets_;
+  /** Current bucket, buckets_ before the first sample */
+  size_t bucket_;
+  Point min_;
+  Point max_;
+  /** True if min_ was received before max_ */
+  bool min_first_ = true;
+  std::vector<Point> & out_;
+};
+
+/** Size of a block of level k + 1 */
+inline uint64_t block_size(size_t k) noexcept
+{
+  uint64_t out = PlotHistory::LEVEL_FACTOR;
+  for(size_t i = 0; i < k; ++i) { out *= PlotHistory::LEVEL_FACTOR; }
+  return out;
+}
+
+inline uint64_t to_bits(double x) noexcept
+{
+  uint64_t out;
+  std::memcpy(&out, &x, sizeof(out));
+  return out;
+}
+
+inline double from_bits(uint64_t bits) noexcept
+{
+  double out;
+  std::memcpy(&out, &bits, sizeof(out));
+  return out;
+}
+
+/** Number of bits needed to represent a non-zero value */
+inline unsigned bit_width(uint64_t value) noexcept
+{
+#ifdef __GNUC__
+  return 64 - static_cast<unsigned>(__builtin_clzll(value));
+#else
+  unsigned out = 0;
+  for(; value; value >>= 1) { ++out; }
+  return out;
+#endif
+}
+
+/** Appends bits to a vector of words, least significant bits first */
+struct BitWriter
+{
+  BitWriter(std::vector<uint64_t> & out) : out_(out) {}
+
+  /** Write the n (<= 64) least significant bits of value, the other bits must be 0 */
+  void write(uint64_t value, unsigned n)
+  {
+    if(n == 0) { return; }
+    unsigned offset = bits_ % 64;
+    if(offset == 0) { out_.push_back(0); }
+    out_.back() |= value << offset;
+    if(offset + n > 64) { out_.push_back(value >> (64 - offset)); }
+    bits_ += n;
+  }
+
+private:
+  std::vector<uint64_t> & out_;
+  size_t bits_ = 0;
+};
+
+/** Reads the bits written by BitWriter */
+struct BitReader
+{
+  BitReader(const std::vector<uint64_t> & in) : in_(in) {}
+
+  uint64_t read(unsigned n)
+  {
+    if(n == 0) { return 0; }
+    size_t word = bits_ / 64;
+    unsigned offset = bits_ % 64;
+    uint64_t out = in_[word] >> offset;
+    if(offset + n > 64) { out |= in_[word + 1] << (64 - offset); }
+    bits_ += n;
+    return n == 64 ? out : out & ((uint64_t(1) << n) - 1);
+  }
+
+private:
+  const std::vector<uint64_t> & in_;
+  size_t bits_ = 0;
+};
+
+/** Compress a block of x
+ *
+ * x is predicted from the two previous values on their bit patterns: for a regularly sampled time the difference
+ * between consecutive bit patterns is (almost) constant so the residual is 0 or a few units. The residual is zigzag
+ * encoded and written as a single 0 bit if it is 0, otherwise as a 1 bit, its width on 6 bits and its bits without
+ * the leading 1.
+ */
+void compress(const std::vector<double> & xs, std::vector<uint64_t> & out)
+{
+  out.clear();
+  BitWriter writer(out);
+  uint64_t prev = 0;
+  uint64_t delta = 0;
+  for(double x : xs)
+  {
+    uint64_t bits = to_bits(x);
+    uint64_t residual = bits - prev - delta;
+    residual = (residual << 1) ^ (0 - (residual >> 63));
+    if(residual == 0) { writer.write(0, 1); }
+    else
+    {
+      unsigned width = bit_width(residual);
+      writer.write(1, 1);
+      writer.write(width - 1, 6);
+      writer.write(residual ^ (uint64_t(1) << (width - 1)), width - 1);
+    }
+    delta = bits - prev;
+    prev = bits;
+  }
+  out.shrink_to_fit();
+}
+
+/** Decompress a block of size values written by compress */
+void decompress(const std::vector<uint64_t> & in, size_t size, std::vector<double> & xs)
+{
+  xs.resize(size);
+  BitReader reader(in);
+  uint64_t prev = 0;
+  uint64_t delta = 0;
+  for(auto & x : xs)
+  {
+    uint64_t residual = 0;
+    if(reader.read(1))
+    {
+      unsigned width = static_cast<unsigned>(reader.read(6)) + 1;
+      residual = reader.read(width - 1) | (uint64_t(1) << (width - 1));
+    }
+    residual = (residual >> 1) ^ (0 - (residual & 1));
+    uint64_t bits = prev + delta + residual;
+    delta = bits - prev;
+    prev = bits;
+    x = from_bits(bits);
+  }
+}
+
+} // namespace
+
+void PlotHistory::options(const Options & options)
+{
+  auto storage = options;
+  if(!sorted())
+  {
+    storage.float_y = false;
+    storage.compress_x = false;
+  }
+  rebuild(storage);
+  version_++;
+}
+
+void PlotHistory::push(double x, double y)
+{
+  if(!contiguous() && size_ && x < last_x_)
+  {
+    /** The compact storage is only used for sorted histories, see options() */
+    auto storage = options_;
+    storage.float_y = false;
+    storage.compress_x = false;
+    rebuild(storage);
+  }
+  append(x, y);
+  if(full_ && options_.span > 0)
+  {
+    /** The buffers were sized for the span at the sampling rate of the time, they are resized if the rate changed
+     * significantly, the margin keeps this rare */
+    double span = last_x_ - this->x(0);
+    bool can_grow = options_.samples == 0 || size_ < options_.samples;
+    if(span > 1.5 * options_.span || (can_grow && span < options_.span / 1.5)) { rebuild(options_); }
+  }
+}
+
+void PlotHistory::append(double x, double y)
+{
+  version_++;
+  if(options_.float_y) { y = static_cast<double>(static_cast<float>(y)); }
+  if(size_ && x < last_x_) { unsorted_ = pushed_ + 1; }
+  last_x_ = x;
+  if(!full_)
+  {
+    if(size_ == capacity_)
+    {
+      /** Grow geometrically but never beyond the sample limit */
+      size_t capacity = std::max<size_t>(2 * capacity_, 1024);
+      if(options_.samples) { capacity = std::min(capacity, options_.samples); }
+      reserve(capacity);
+    }
+    if(!options_.compress_x) { xs_.push_back(x); }
+    if(options_.float_y) { ys32_.push_back(static_cast<float>(y)); }
+    else { ys_.push_back(y); }
+    if(size_ == 0) { first_x_ = x; }
+    size_++;
+  }
+  else
+  {
+    /** The extents must be computed again if the dropped sample was on the boundary */
+    auto p = front();
+    if(p.x <= extents_.x_min || p.x >= extents_.x_max || p.y <= extents_.y_min || p.y >= extents_.y_max)
+    {
+      extents_valid_ = false;
+    }
+    if(!options_.compress_x) { xs_[head_] = x; }
+    if(options_.float_y) { ys32_[head_] = static_cast<float>(y); }
+    else { ys_[head_] = y; }
+    head_ = head_ + 1 < size_ ? head_ + 1 : 0;
+  }
+  pushed_++;
+  if(options_.compress_x)
+  {
+    x_hot_.push_back(x);
+    if(x_hot_.size() == X_BLOCK_SIZE)
+    {
+      x_blocks_.emplace_back();
+      compress(x_hot_, x_blocks_.back());
+      x_hot_.clear();
+    }
+    /** Drop the blocks that only hold samples out of the window */
+    while(x_blocks_.size() && (x_first_block_ + 1) * X_BLOCK_SIZE <= sequence(0))
+    {
+      x_blocks_.pop_front();
+      x_first_block_++;
+    }
+  }
+  add_to_levels(pushed_ - 1, {x, y}, size_ == 1);
+  if(size_ == 1)
+  {
+    extents_ = {x, x, y, y};
+    extents_valid_ = true;
+  }
+  else
+  {
+    extents_.x_min = std::min(extents_.x_min, x);
+    extents_.x_max = std::max(extents_.x_max, x);
+    extents_.y_min = std::min(extents_.y_min, y);
+    extents_.y_max = std::max(extents_.y_max, y);
+  }
+  if(!full_)
+  {
+    full_ = (options_.samples && size_ >= options_.samples) || (options_.span > 0 && x - first_x_ >= options_.span);
+  }
+}
+
+double PlotHistory::x_at(uint64_t seq) const noexcept
+{
+  uint64_t block = seq / X_BLOCK_SIZE;
+  if(block == x_first_block_ + x_blocks_.size()) { return x_hot_[seq % X_BLOCK_SIZE]; }
+  if(block != x_cache_block_)
+  {
+    decompress(x_blocks_[static_cast<size_t>(block - x_first_block_)], X_BLOCK_SIZE, x_cache_);
+    x_cache_block_ = block;
+  }
+  return x_cache_[seq % X_BLOCK_SIZE];
+}
+
+void PlotHistory::copy(std::vector<Point> & out) const
+{
+  out.resize(size_);
+  for(size_t i = 0; i < size_; ++i) { out[i] = (*this)[i]; }
+}
+
+size_t PlotHistory::lower_bound(double x) const noexcept
+{
+  size_t first = 0;
+  size_t count = size();
+  while(count > 0)
+  {
+    size_t step = count / 2;
+    if(this->x(first + step) < x)
+    {
+      first += step + 1;
+      count -= step + 1;
+    }
+    else
+    {
+      count = step;
+    }
+  }
+  return first;
+}
+
+size_t PlotHistory::upper_bound(double x) const noexcept
+{
+  size_t first = 0;
+  size_t count = size();
+  while(count > 0)
+  {
+    size_t step = count / 2;
+    if(!(x < this->x(first + step)))
+    {
+      first += step + 1;
+      count -= step + 1;
+    }
+    else
+    {
+      count = step;
+    }
+  }
+  return first;
+}
+
+void PlotHistory::decimate(double x_min, double x_max, size_t buckets, std::vector<Point> & out) const
+{
+  out.clear();
+  if(empty() || buckets == 0) { return; }
+  out.reserve(2 * buckets + 2);
+  size_t begin = lower_bound(x_min);
+  size_t end = upper_bound(x_max);
+  if(begin > 0) { out.push_back((*this)[begin - 1]); }
+  Reducer reducer(x_min, x_max, buckets, out);
+  /** Coarsest level with at least two blocks per bucket, -1 for the samples themselves */
+  int level = -1;
+  uint64_t samples_per_bucket = (end - begin) / buckets;
+  while(static_cast<size_t>(level + 1) < levels_.size()
+        && 2 * block_size(static_cast<size_t>(level + 1)) <= samples_per_bucket)
+  {
+    ++level;
+  }
+  size_t i = begin;
+  if(level >= 0)
+  {
+    const auto & blocks = levels_[static_cast<size_t>(level)];
+    auto block_samples = block_size(static_cast<size_t>(level));
+    /** Samples before the first complete block, then complete blocks, then the remaining samples */
+    uint64_t first_block = (sequence(begin) + block_samples - 1) / block_samples;
+    uint64_t last_block = sequence(end) / block_samples;
+    if(first_block < last_block)
+    {
+      for(; sequence(i) < first_block * block_samples; ++i) { reducer.add((*this)[i]); }
+      for(uint64_t j = first_block; j < last_block; ++j)
+      {
+        const auto & block = blocks[j % blocks.size()];
+        reducer.add(block.first);
+        reducer.add(block.second);
+      }
+      i = static_cast<size_t>(last_block * block_samples - sequence(0));
+    }
+  }
+  for(; i < end; ++i) { reducer.add((*this)[i]); }
+  reducer.flush();
+  if(end < size()) { out.push_back((*this)[end]); }
+}
+
+auto PlotHistory::extents() const noexcept -> const Extents &
+{
+  if(extents_valid_) { return extents_; }
+  extents_.y_min = std::numeric_limits<double>::infinity();
+  extents_.y_max = -std::numeric_limits<double>::infinity();
+  y_extremes(sequence(0), pushed_, static_cast<int>(levels_.size()) - 1, extents_.y_min, extents_.y_max);
+  if(sorted())
+  {
+    extents_.x_min = front().x;
+    extents_.x_max = back().x;
+  }
+  else
+  {
+    extents_.x_min = std::numeric_limits<double>::infinity();
+    extents_.x_max = -std::numeric_limits<double>::infinity();
+    for(size_t i = 0; i < size_; ++i)
+    {
+      double x = this->x(i);
+      extents_.x_min = std::min(extents_.x_min, x);
+      extents_.x_max = std::max(extents_.x_max, x);
+    }
+  }
+  extents_valid_ = true;
+  return extents_;
+}
+
+void PlotHistory::y_extremes(uint64_t begin, uint64_t end, int level, double & min, double & max) const noexcept
+{
+  if(level < 0)
+  {
+    for(auto seq = begin; seq < end; ++seq)
+    {
+      double y = this->y(static_cast<size_t>(seq - sequence(0)));
+      min = std::min(min, y);
+      max = std::max(max, y);
+    }
+    return;
+  }
+  const auto & blocks = levels_[static_cast<size_t>(level)];
+  auto block_samples = block_size(static_cast<size_t>(level));
+  uint64_t first_block = (begin + block_samples - 1) / block_samples;
+  uint64_t last_block = end / block_samples;
+  if(first_block >= last_block)
+  {
+    y_extremes(begin, end, level - 1, min, max);
+    return;
+  }
+  y_extremes(begin, first_block * block_samples, level - 1, min, max);
+  for(uint64_t j = first_block; j < last_block; ++j)
+  {
+    const auto & block = blocks[j % blocks.size()];
+    min = std::min({min, block.first.y, block.second.y});
+    max = std::max({max, block.first.y, block.second.y});
+  }
+  y_extremes(last_block * block_samples, end, level - 1, min, max);
+}
+
+void PlotHistory::add_to_levels(uint64_t seq, const Point & p, bool first)
+{
+  for(size_t k = 0; k < levels_.size(); ++k)
+  {
+    auto & level = levels_[k];
+    auto block_samples = block_size(k);
+    auto & block = level[(seq / block_samples) % level.size()];
+    if(first || seq % block_samples == 0)
+    {
+      block = {p, p};
+      continue;
+    }
+    bool min_first = block.first.y <= block.second.y;
+    const auto & min = min_first ? block.first : block.second;
+    const auto & max = min_first ? block.second : block.first;
+    if(p.y < min.y) { block = Summary{max, p}; }
+    else if(p.y > max.y) { block = Summary{min, p}; }
+  }
+}
+
+void PlotHistory::reserve(size_t capacity)
+{
+  capacity_ = capacity;
+  if(!options_.compress_x) { xs_.reserve(capacity_); }
+  if(options_.float_y) { ys32_.reserve(capacity_); }
+  else { ys_.reserve(capacity_); }
+  build_levels();
+}
+
+void PlotHistory::build_levels()
+{
+  levels_.clear();
+  for(size_t k = 0; block_size(k) <= capacity_; ++k)
+  {
+    /** A window of capacity samples spans at most capacity / size + 2 blocks */
+    levels_.emplace_back(capacity_ / block_size(k) + 2);
+  }
+  for(size_t i = 0; i < size_; ++i) { add_to_levels(sequence(i), (*this)[i], i == 0); }
+}
+
+void PlotHistory::rebuild(const Options & options)
+{
+  std::vector<Point> points;
+  copy(points);
+  options_ = options;
+  size_t drop = 0;
+  if(options_.samples && points.size() > options_.samples) { drop = points.size() - options_.samples; }
+  if(options_.span > 0 && points.size())
+  {
+    double min_x = points.back().x - options_.span;
+    while(drop < points.size() && points[drop].x < min_x) { ++drop; }
+  }
+  /** Release the memory of the previous storage */
+  xs_ = {};
+  ys_ = {};
+  ys32_ = {};
+  x_blocks_.clear();
+  x_first_block_ = 0;
+  x_hot_ = {};
+  x_cache_block_ = std::numeric_limits<uint64_t>::max();
+  size_ = 0;
+  head_ = 0;
+  full_ = false;
+  pushed_ = 0;
+  unsorted_ = 0;
+  extents_valid_ = false;
+  size_t capacity = std::max<size_t>(points.size() - drop, 1024);
+  if(options_.samples) { capacity = std::min(capacity, options_.samples); }
+  reserve(capacity);
+  if(options_.compress_x) { x_hot_.reserve(X_BLOCK_SIZE); }
+  for(size_t i = drop; i < points.size(); ++i) { append(points[i].x, points[i].y); }
+}
+
+} // namespace mc_rtc::imgui
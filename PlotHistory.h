@@ -0,0 +1,238 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <vector>
+
+namespace mc_rtc::imgui
+{
+
+/** Samples of a plot line
+ *
+ * The samples are kept in ring buffers bounded by \ref Options, once the buffers are full a new sample replaces the
+ * oldest one. x and y are stored in separate arrays. By default both are arrays of double and the oldest sample is at
+ * \ref offset(), this is the layout ImPlot expects for its offset/stride API so the history is plotted without copies
+ * (see \ref contiguous()). The history can also use a compact storage: float y and/or compressed x.
+ *
+ * The history also maintains a min/max pyramid: level k keeps the extremes of every block of LEVEL_FACTOR^k samples.
+ * It is updated in O(levels) when a sample is added and lets \ref decimate() work on blocks instead of samples.
+ */
+struct PlotHistory
+{
+  struct Point
+  {
+    double x;
+    double y;
+  };
+
+  /** Number of samples (resp. blocks) of a level summarized by a block of the next level */
+  static constexpr size_t LEVEL_FACTOR = 8;
+
+  /** Number of x values in a compressed block, see \ref Options::compress_x */
+  static constexpr size_t X_BLOCK_SIZE = 1024;
+
+  /** Bounds and storage of the history, a bound set to 0 is disabled */
+  struct Options
+  {
+    /** Maximum number of samples */
+    size_t samples = 1000000;
+    /** Span of the samples on the x axis, e.g. the time window shown for a time-based plot
+     *
+     * x is expected to increase from one sample to the next when this is set
+     */
+    double span = 0.0;
+    /** Store y as float, this halves the memory used by y and loses precision */
+    bool float_y = false;
+    /** Compress x by blocks of X_BLOCK_SIZE samples, this is lossless
+     *
+     * Each x is predicted from the bit patterns of the two previous ones and only the difference is stored so a
+     * regularly sampled time compresses to a few bits per sample. The most recent block is not compressed, the others
+     * are decompressed when they are read.
+     */
+    bool compress_x = false;
+  };
+
+  /** Change the options, the samples are stored again if the storage changes and the oldest samples are dropped if
+   * they do not fit the bounds
+   *
+   * The compact storage (float_y and compress_x) is only used for sorted histories: it is ignored if the history is
+   * not sorted and dropped as soon as a sample with a lower x than the previous one is pushed, \ref options() then
+   * returns the options in use.
+   */
+  void options(const Options & options);
+
+  inline const Options & options() const noexcept { return options_; }
+
+  /** Add a sample */
+  void push(double x, double y);
+
+  /** Number of samples */
+  inline size_t size() const noexcept { return size_; }
+
+  inline bool empty() const noexcept { return size_ == 0; }
+
+  /** True if x and y are stored as arrays of double, see \ref xs() and \ref ys() */
+  inline bool contiguous() const noexcept { return !options_.float_y && !options_.compress_x; }
+
+  /** x values, the history must be contiguous, see \ref offset() */
+  inline const double * xs() const noexcept { return xs_.data(); }
+
+  /** y values, the history must be contiguous, see \ref offset() */
+  inline const double * ys() const noexcept { return ys_.data(); }
+
+  /** Index of the oldest sample in \ref xs() and \ref ys() */
+  inline size_t offset() const noexcept { return head_; }
+
+  /** x of the i-th oldest sample */
+  inline double x(size_t i) const noexcept { return options_.compress_x ? x_at(sequence(i)) : xs_[slot(i)]; }
+
+  /** y of the i-th oldest sample */
+  inline double y(size_t i) const noexcept
+  { return options_.float_y ? static_cast<double>(ys32_[slot(i)]) : ys_[slot(i)]; }
+
+  /** i-th oldest sample */
+  inline Point operator[](size_t i) const noexcept { return {x(i), y(i)}; }
+
+  /** Oldest sample, the history must not be empty */
+  inline Point front() const noexcept { return (*this)[0]; }
+
+  /** Most recent sample, the history must not be empty */
+  inline Point back() const noexcept { return (*this)[size_ - 1]; }
+
+  /** Copy all the samples, oldest first */
+  void copy(std::vector<Point> & out) const;
+
+  /** Bounding box of the samples */
+  struct Extents
+  {
+    double x_min;
+    double x_max;
+    double y_min;
+    double y_max;
+  };
+
+  /** Extents of the samples, the history must not be empty
+   *
+   * The extents are updated when a sample is added. They are only computed again when a sample on the boundary is
+   * dropped, this uses the pyramid for y and the first and last samples for x if the history is sorted.
+   */
+  const Extents & extents() const noexcept;
+
+  /** Changes every time the samples change */
+  inline uint64_t version() const noexcept { return version_; }
+
+  /** True if x never decreases from the oldest to the most recent sample */
+  inline bool sorted() const noexcept { return unsorted_ == 0 || unsorted_ - 1 <= pushed_ - size_; }
+
+  /** Index of the first sample with x greater or equal to the given value, the history must be sorted */
+  size_t lower_bound(double x) const noexcept;
+
+  /** Index of the first sample with x greater than the given value, the history must be sorted */
+  size_t upper_bound(double x) const noexcept;
+
+  /** Reduce the samples with x in [x_min, x_max] to the minimum and maximum y of each bucket
+   *
+   * The range is split in buckets of the same width, e.g. one per pixel, the extremes of every bucket are kept in
+   * their original order so spikes are never dropped. The samples right outside the range are kept as well so that
+   * the line reaches the edges of the plot. The history must be sorted.
+   *
+   * The coarsest level of the pyramid with at least two blocks per bucket is used, hence this costs
+   * O(buckets * LEVEL_FACTOR + log(size())) regardless of the number of samples in the range.
+   *
+   * \param out Decimated samples, cleared first
+   */
+  void decimate(double x_min, double x_max, size_t buckets, std::vector<Point> & out) const;
+
+private:
+  Options options_;
+  /** See \ref size() */
+  size_t size_ = 0;
+  /** Number of samples the buffers can hold before they grow */
+  size_t capacity_ = 0;
+  /** Index of the oldest sample in the ring buffers, always 0 until the buffers are full */
+  size_t head_ = 0;
+  /** True when the buffers are full, new samples then replace the oldest ones */
+  bool full_ = false;
+  /** x of the oldest sample while the buffers are not full and of the most recent sample */
+  double first_x_ = 0.0;
+  double last_x_ = 0.0;
+  /** See \ref version() */
+  uint64_t version_ = 0;
+  /** Number of samples pushed since the storage was (re)built */
+  uint64_t pushed_ = 0;
+  /** 1 + the sequence number of the last sample whose x is lower than the previous one, 0 if there is none */
+  uint64_t unsorted_ = 0;
+
+  /** Ring buffer of x, unused if x is compressed */
+  std::vector<double> xs_;
+  /** Ring buffer of y, unused if y is stored as float */
+  std::vector<double> ys_;
+  /** Ring buffer of y when y is stored as float */
+  std::vector<float> ys32_;
+
+  /** Compressed blocks of x, block j holds the x of the samples with sequence numbers in
+   * [j * X_BLOCK_SIZE, (j + 1) * X_BLOCK_SIZE) */
+  std::deque<std::vector<uint64_t>> x_blocks_;
+  /** Index of the first block in x_blocks_ */
+  uint64_t x_first_block_ = 0;
+  /** x of the block being filled, it is compressed once full */
+  std::vector<double> x_hot_;
+  /** Last block decompressed by \ref x_at() */
+  mutable std::vector<double> x_cache_;
+  mutable uint64_t x_cache_block_ = std::numeric_limits<uint64_t>::max();
+
+  /** Extremes of a block of samples in the order they were received, both are the same sample for a single one */
+  struct Summary
+  {
+    Point first;
+    Point second;
+  };
+  /** Level k + 1 of the pyramid, block j of LEVEL_FACTOR^(k + 1) samples is at j % levels_[k].size()
+   *
+   * The blocks are indexed by the sequence number of their samples so that they stay valid when the ring buffer
+   * wraps around, the levels are sized after the capacity of the storage.
+   */
+  std::vector<std::vector<Summary>> levels_;
+
+  /** See \ref extents(), computed on demand when extents_valid_ is false */
+  mutable Extents extents_;
+  mutable bool extents_valid_ = false;
+
+  /** Index of the i-th oldest sample in the ring buffers */
+  inline size_t slot(size_t i) const noexcept
+  {
+    i += head_;
+    return i < size_ ? i : i - size_;
+  }
+
+  /** Sequence number of the i-th oldest sample */
+  inline uint64_t sequence(size_t i) const noexcept { return pushed_ - size_ + i; }
+
+  /** x of the sample with the given sequence number when x is compressed */
+  double x_at(uint64_t seq) const noexcept;
+
+  /** Add a sample, \ref push() also checks that the storage still fits the span */
+  void append(double x, double y);
+
+  /** Extend min and max with the y extremes of the samples with sequence numbers in [begin, end)
+   *
+   * The blocks of the given level are used for the complete blocks in the range and finer levels for the rest
+   */
+  void y_extremes(uint64_t begin, uint64_t end, int level, double & min, double & max) const noexcept;
+
+  /** Add a sample to the levels, seq is its sequence number */
+  void add_to_levels(uint64_t seq, const Point & p, bool first);
+
+  /** Set the capacity of the storage and build the levels for it */
+  void reserve(size_t capacity);
+
+  /** Build the levels from the samples, used when the capacity of the storage changes */
+  void build_levels();
+
+  /** Store the samples that fit the given options again, the buffers grow again after that */
+  void rebuild(const Options & options);
+};
+
+} // namespace mc_rtc::imgui
@@ -0,0 +1,155 @@
+#include "Recording.h"
+
+#include "Client.h"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+
+#ifndef _WIN32
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace mc_rtc::imgui
+{
+
+namespace
+{
+
+constexpr char MAGIC[8] = {'M', 'C', 'R', 'T', 'C', 'G', 'U', 'I'};
+
+constexpr size_t HEADER_SIZE = sizeof(int64_t) + sizeof(uint64_t);
+
+int64_t steady_now() noexcept
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+} // namespace
+
+Recorder::Recorder(const std::string & path) : path_(path), file_(std::fopen(path.c_str(), "wb"))
+{
+  if(!file_) { mc_rtc::log::error_and_throw("[mc_rtc::imgui] Failed to open {} to record the GUI messages", path); }
+  std::fwrite(MAGIC, 1, sizeof(MAGIC), file_);
+}
+
+Recorder::~Recorder()
+{ std::fclose(file_); }
+
+void Recorder::write(int64_t time, const char * data, size_t size)
+{
+  uint64_t size_ = size;
+  bool ok = std::fwrite(&time, sizeof(time), 1, file_) == 1 && std::fwrite(&size_, sizeof(size_), 1, file_) == 1
+            && std::fwrite(data, 1, size, file_) == size;
+  /** Flushed on every message so that the recording is complete if the application crashes */
+  ok = ok && std::fflush(file_) == 0;
+  if(!ok) { mc_rtc::log::error("[mc_rtc::imgui] Failed to write to the recording {}", path_); }
+  messages_++;
+}
+
+Replay::Replay(const std::string & path) : path_(path)
+{
+#ifndef _WIN32
+  int fd = ::open(path.c_str(), O_RDONLY);
+  struct stat st;
+  if(fd < 0 || ::fstat(fd, &st) != 0)
+  {
+    if(fd >= 0) { ::close(fd); }
+    mc_rtc::log::error_and_throw("[mc_rtc::imgui] Failed to open the recording {}", path);
+  }
+  size_ = static_cast<size_t>(st.st_size);
+  if(size_)
+  {
+    void * data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(data == MAP_FAILED)
+    {
+      ::close(fd);
+      mc_rtc::log::error_and_throw("[mc_rtc::imgui] Failed to map the recording {}", path);
+    }
+    data_ = static_cast<const char *>(data);
+  }
+  ::close(fd);
+#else
+  std::ifstream ifs(path, std::ios::binary);
+  if(!ifs) { mc_rtc::log::error_and_throw("[mc_rtc::imgui] Failed to open the recording {}", path); }
+  buffer_.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+  data_ = buffer_.data();
+  size_ = buffer_.size();
+#endif
+  if(size_ < sizeof(MAGIC) || std::memcmp(data_, MAGIC, sizeof(MAGIC)) != 0)
+  {
+    /** The destructor does not run if the constructor throws */
+    unmap();
+    mc_rtc::log::error_and_throw("[mc_rtc::imgui] {} is not a GUI recording", path);
+  }
+  size_t offset = sizeof(MAGIC);
+  while(offset + HEADER_SIZE <= size_)
+  {
+    Message msg;
+    uint64_t msg_size;
+    std::memcpy(&msg.time, data_ + offset, sizeof(msg.time));
+    std::memcpy(&msg_size, data_ + offset + sizeof(msg.time), sizeof(msg_size));
+    offset += HEADER_SIZE;
+    if(msg_size > size_ - offset)
+    {
+      mc_rtc::log::warning("[mc_rtc::imgui] {} ends with an incomplete message, it will be ignored", path);
+      break;
+    }
+    msg.data = data_ + offset;
+    msg.size = static_cast<size_t>(msg_size);
+    messages_.push_back(msg);
+    offset += msg.size;
+  }
+}
+
+Replay::~Replay()
+{ unmap(); }
+
+void Replay::unmap() noexcept
+{
+#ifndef _WIN32
+  if(data_) { ::munmap(const_cast<char *>(data_), size_); }
+#endif
+  data_ = nullptr;
+}
+
+bool Replay::update(Client & client, bool realtime)
+{
+  if(done()) { return false; }
+  if(!realtime)
+  {
+    const auto & msg = messages_[next_++];
+    client.handle_message(msg.data, msg.size);
+    return true;
+  }
+  auto now = steady_now();
+  if(start_ < 0) { start_ = now; }
+  auto elapsed = now - start_;
+  auto t0 = messages_.front().time;
+  size_t last = next_;
+  while(last < messages_.size() && messages_[last].time - t0 <= elapsed) { ++last; }
+  for(; next_ < last; ++next_)
+  {
+    const auto & msg = messages_[next_];
+    client.handle_message(msg.data, msg.size, next_ + 1 == last);
+  }
+  return true;
+}
+
+void Replay::restart() noexcept
+{
+  next_ = 0;
+  start_ = -1;
+}
+
+double Replay::duration() const noexcept
+{
+  if(messages_.empty()) { return 0.0; }
+  return static_cast<double>(messages_.back().time - messages_.front().time) * 1e-9;
+}
+
+} // namespace mc_rtc::imgui
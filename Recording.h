@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace mc_rtc::imgui
+{
+
+struct Client;
+
+/** Recording of the raw messages sent by the GUI server
+ *
+ * A recording starts with an 8 bytes magic string followed by the messages. Each message is stored as its reception
+ * time (int64_t, ns since the epoch), its size (uint64_t) and its content. Messages are only ever appended and flushed
+ * one by one so that a recording interrupted by a crash can still be replayed up to the last complete message.
+ */
+struct Recorder
+{
+  /** Create (or truncate) the recording at path, throws if the file cannot be opened */
+  Recorder(const std::string & path);
+
+  ~Recorder();
+
+  Recorder(const Recorder &) = delete;
+  Recorder & operator=(const Recorder &) = delete;
+
+  /** Append a message received at the given time */
+  void write(int64_t time, const char * data, size_t size);
+
+  /** Number of messages written */
+  inline uint64_t messages() const noexcept { return messages_; }
+
+private:
+  std::string path_;
+  std::FILE * file_ = nullptr;
+  uint64_t messages_ = 0;
+};
+
+/** Replay a recording made by \ref Recorder through a client
+ *
+ * The recording is memory-mapped, messages are fed to the client without copying them.
+ */
+struct Replay
+{
+  /** Open a recording, throws if the file cannot be opened or is not a recording */
+  Replay(const std::string & path);
+
+  ~Replay();
+
+  Replay(const Replay &) = delete;
+  Replay & operator=(const Replay &) = delete;
+
+  /** Feed the next messages to the client
+   *
+   * \param realtime If true, every message due since the replay started is fed to the client following the original
+   * timing, older messages are handled like skipped messages. Otherwise the next message is fed immediately.
+   *
+   * \returns False once every message has been fed
+   */
+  bool update(Client & client, bool realtime = true);
+
+  /** Start again from the first message */
+  void restart() noexcept;
+
+  /** True if every message has been fed */
+  inline bool done() const noexcept { return next_ == messages_.size(); }
+
+  /** Number of messages in the recording */
+  inline size_t size() const noexcept { return messages_.size(); }
+
+  /** Duration of the recording in seconds */
+  double duration() const noexcept;
+
+private:
+  struct Message
+  {
+    int64_t time;
+    const char * data;
+    size_t size;
+  };
+  std::string path_;
+  const char * data_ = nullptr;
+  size_t size_ = 0;
+  /** Used instead of a mapping when memory-mapping is not available */
+  std::vector<char> buffer_;
+  std::vector<Message> messages_;
+  size_t next_ = 0;
+  /** Steady clock time (ns) matching the first message, set on the first update */
+  int64_t start_ = -1;
+
+  /** Release the mapping of the recording */
+  void unmap() noexcept;
+};
+
+} // namespace mc_rtc::imgui
@@ -0,0 +1,51 @@
+#include "SlabPool.h"
+
+#include <new>
+
+namespace mc_rtc::imgui
+{
+
+void * SlabPool::allocate(size_t size)
+{
+  stats_.allocations++;
+  stats_.live++;
+  if(size > MAX_SIZE)
+  {
+    stats_.heap_allocations++;
+    return ::operator new(size);
+  }
+  auto idx = (size + ALIGNMENT - 1) / ALIGNMENT - 1;
+  auto & head = free_[idx];
+  if(head)
+  {
+    auto * out = head;
+    head = head->next;
+    return out;
+  }
+  /** Carve a new slab and thread its objects into the free list */
+  auto stride = (idx + 1) * ALIGNMENT;
+  auto & slab = slabs_.emplace_back(new char[stride * OBJECTS_PER_SLAB]);
+  stats_.heap_allocations++;
+  stats_.slab_bytes += stride * OBJECTS_PER_SLAB;
+  for(size_t i = OBJECTS_PER_SLAB - 1; i > 0; --i)
+  {
+    head = new(slab.get() + i * stride) FreeNode{head};
+  }
+  return slab.get();
+}
+
+void SlabPool::deallocate(void * ptr, size_t size) noexcept
+{
+  if(!ptr) { return; }
+  stats_.deallocations++;
+  stats_.live--;
+  if(size > MAX_SIZE)
+  {
+    ::operator delete(ptr);
+    return;
+  }
+  auto & head = free_[(size + ALIGNMENT - 1) / ALIGNMENT - 1];
+  head = new(ptr) FreeNode{head};
+}
+
+} // namespace mc_rtc::imgui
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace mc_rtc::imgui
+{
+
+/** Slab allocator for the GUI elements
+ *
+ * Objects are grouped by size class, in practice every concrete type gets its own class. Memory is taken from the heap
+ * one slab at a time and released objects are kept in a free list so that elements that come and go, e.g. on
+ * controller state transitions, re-use the memory of the elements that were destroyed.
+ *
+ * Memory is never given back to the heap. The pool is not thread-safe, elements must only be created and destroyed by
+ * the thread that handles the GUI.
+ */
+struct SlabPool
+{
+  struct Stats
+  {
+    /** Number of objects allocated by the pool */
+    uint64_t allocations = 0;
+    /** Number of objects given back to the pool */
+    uint64_t deallocations = 0;
+    /** Number of heap allocations made by the pool (slabs and objects too large for a slab) */
+    uint64_t heap_allocations = 0;
+    /** Number of objects currently allocated */
+    uint64_t live = 0;
+    /** Memory obtained from the heap for the slabs */
+    size_t slab_bytes = 0;
+  };
+
+  /** Alignment of the objects in the pool */
+  static constexpr size_t ALIGNMENT = alignof(std::max_align_t);
+
+  /** Objects larger than this are allocated on the heap directly */
+  static constexpr size_t MAX_SIZE = 2048;
+
+  /** Number of objects in a slab */
+  static constexpr size_t OBJECTS_PER_SLAB = 32;
+
+  void * allocate(size_t size);
+
+  void deallocate(void * ptr, size_t size) noexcept;
+
+  inline const Stats & stats() const noexcept { return stats_; }
+
+private:
+  struct FreeNode
+  {
+    FreeNode * next;
+  };
+  /** Free list for each size class */
+  std::vector<FreeNode *> free_ = std::vector<FreeNode *>(MAX_SIZE / ALIGNMENT, nullptr);
+  std::vector<std::unique_ptr<char[]>> slabs_;
+  Stats stats_;
+};
+
+/** Provides class-specific allocation functions so that a base class and all its subclasses are allocated from a
+ * dedicated pool
+ *
+ * \tparam Tag Identifies the pool, usually the base class itself
+ */
+template<typename Tag>
+struct SlabAllocated
+{
+  /** The pool is never destroyed as objects might outlive static destruction */
+  static inline SlabPool & pool() noexcept
+  {
+    static auto * pool = new SlabPool();
+    return *pool;
+  }
+
+  static inline void * operator new(size_t size) { return pool().allocate(size); }
+
+  static inline void operator delete(void * ptr, size_t size) noexcept { pool().deallocate(ptr, size); }
+};
+
+} // namespace mc_rtc::imgui
@@ -0,0 +1,154 @@
+#include "Trace.h"
+
+#include <mc_rtc/logging.h>
+
+#ifdef MC_RTC_IMGUI_ENABLE_TRACE
+#  include <algorithm>
+#  include <array>
+#  include <atomic>
+#  include <fstream>
+#  include <iomanip>
+#  include <memory>
+#  include <mutex>
+#  include <vector>
+#endif
+
+namespace mc_rtc::imgui::trace
+{
+
+#ifdef MC_RTC_IMGUI_ENABLE_TRACE
+
+namespace
+{
+
+struct Event
+{
+  const char * name;
+  int64_t begin;
+  /** End of a complete event or value of a counter event */
+  int64_t end;
+  bool counter;
+};
+
+/** Events recorded by a thread
+ *
+ * Only the owning thread writes to the buffer, it overwrites the oldest events once the buffer is full
+ */
+struct Buffer
+{
+  static constexpr size_t SIZE = 1 << 16;
+
+  Buffer(size_t tid) : tid(tid) {}
+
+  size_t tid;
+  std::array<Event, SIZE> events;
+  /** Number of events ever written */
+  std::atomic<uint64_t> count{0};
+
+  inline void push(const Event & event) noexcept
+  {
+    auto i = count.load(std::memory_order_relaxed);
+    events[i % SIZE] = event;
+    count.store(i + 1, std::memory_order_release);
+  }
+};
+
+/** Buffers of every thread that recorded an event, they are never released so that dump() sees exited threads */
+struct Registry
+{
+  std::mutex mutex;
+  std::vector<std::unique_ptr<Buffer>> buffers;
+};
+
+Registry & registry()
+{
+  static auto * registry = new Registry();
+  return *registry;
+}
+
+Buffer & buffer()
+{
+  thread_local Buffer * buffer = []()
+  {
+    auto & reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    return reg.buffers.emplace_back(std::make_unique<Buffer>(reg.buffers.size())).get();
+  }();
+  return *buffer;
+}
+
+void write_name(std::ostream & os, const char * name)
+{
+  os << '"';
+  for(; *name; ++name)
+  {
+    if(*name == '"' || *name == '\\') { os << '\\'; }
+    os << *name;
+  }
+  os << '"';
+}
+
+} // namespace
+
+void record(const char * name, int64_t begin, int64_t end) noexcept
+{ buffer().push({name, begin, end, false}); }
+
+void record_value(const char * name, int64_t value) noexcept
+{ buffer().push({name, now(), value, true}); }
+
+bool dump(const std::string & path)
+{
+  std::ofstream os(path);
+  if(!os)
+  {
+    mc_rtc::log::error("[mc_rtc::imgui] Failed to open {} to write the trace", path);
+    return false;
+  }
+  std::vector<Event> events;
+  os << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+  bool first = true;
+  auto & reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  for(const auto & buffer : reg.buffers)
+  {
+    auto end = buffer->count.load(std::memory_order_acquire);
+    auto begin = end > Buffer::SIZE ? end - Buffer::SIZE : 0;
+    events.clear();
+    for(auto i = begin; i < end; ++i) { events.push_back(buffer->events[i % Buffer::SIZE]); }
+    /** The owner might have overwritten the oldest events while we were copying */
+    auto written = buffer->count.load(std::memory_order_acquire);
+    auto valid = written >= Buffer::SIZE ? written - Buffer::SIZE + 1 : 0;
+    auto skip = static_cast<size_t>(std::min(end, std::max(begin, valid)) - begin);
+    for(auto it = events.begin() + static_cast<long>(skip); it != events.end(); ++it)
+    {
+      const auto & e = *it;
+      os << (first ? "\n" : ",\n") << "{\"name\":";
+      write_name(os, e.name);
+      os << ",\"pid\":0,\"tid\":" << buffer->tid << ",\"ts\":" << static_cast<double>(e.begin) / 1000.0;
+      if(e.counter) { os << ",\"ph\":\"C\",\"args\":{\"value\":" << e.end << "}}"; }
+      else
+      {
+        os << ",\"ph\":\"X\",\"dur\":" << static_cast<double>(e.end - e.begin) / 1000.0 << "}";
+      }
+      first = false;
+    }
+  }
+  os << "\n]}\n";
+  return static_cast<bool>(os);
+}
+
+#else
+
+void record(const char *, int64_t, int64_t) noexcept {}
+
+void record_value(const char *, int64_t) noexcept {}
+
+bool dump(const std::string &)
+{
+  mc_rtc::log::warning("[mc_rtc::imgui] Tracing is disabled, define MC_RTC_IMGUI_ENABLE_TRACE to enable it");
+  return false;
+}
+
+#endif
+
+} // namespace mc_rtc::imgui::trace
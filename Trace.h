@@ -0,0 +1,68 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/** Tracing of the client hot paths
+ *
+ * Spans are recorded with MC_RTC_IMGUI_TRACE(name) which measures the enclosing scope, name must be a string literal.
+ * MC_RTC_IMGUI_TRACE_VALUE(name, value) records a counter event with a numeric value, e.g. the size of a message.
+ *
+ * Both macros expand to nothing unless MC_RTC_IMGUI_ENABLE_TRACE is defined when the sources are compiled. The events
+ * can be written to a Chrome trace file with \ref mc_rtc::imgui::trace::dump() and opened in chrome://tracing or
+ * Perfetto.
+ */
+
+namespace mc_rtc::imgui::trace
+{
+
+/** Write all recorded events to a Chrome trace JSON file
+ *
+ * This can be called while other threads record events, events that are overwritten during the dump are dropped
+ *
+ * \returns False if the file could not be written or tracing is disabled
+ */
+bool dump(const std::string & path);
+
+/** Record a complete event, this is used by \ref Span */
+void record(const char * name, int64_t begin, int64_t end) noexcept;
+
+/** Record a counter event */
+void record_value(const char * name, int64_t value) noexcept;
+
+/** Current time in ns */
+inline int64_t now() noexcept
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/** Record the lifetime of the object as a complete event */
+struct Span
+{
+  inline Span(const char * name) noexcept : name_(name), begin_(now()) {}
+
+  inline ~Span() { record(name_, begin_, now()); }
+
+  Span(const Span &) = delete;
+  Span & operator=(const Span &) = delete;
+
+private:
+  const char * name_;
+  int64_t begin_;
+};
+
+} // namespace mc_rtc::imgui::trace
+
+#ifdef MC_RTC_IMGUI_ENABLE_TRACE
+#  define MC_RTC_IMGUI_TRACE_CONCAT_(a, b) a##b
+#  define MC_RTC_IMGUI_TRACE_CONCAT(a, b) MC_RTC_IMGUI_TRACE_CONCAT_(a, b)
+#  define MC_RTC_IMGUI_TRACE(name) \
+    ::mc_rtc::imgui::trace::Span MC_RTC_IMGUI_TRACE_CONCAT(mc_rtc_imgui_trace_span_, __LINE__)(name)
+#  define MC_RTC_IMGUI_TRACE_VALUE(name, value) \
+    ::mc_rtc::imgui::trace::record_value(name, static_cast<int64_t>(value))
+#else
+#  define MC_RTC_IMGUI_TRACE(name)
+#  define MC_RTC_IMGUI_TRACE_VALUE(name, value)
+#endif
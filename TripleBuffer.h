@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace mc_rtc::imgui
+{
+
+/** Lock-free single producer/single consumer triple buffer
+ *
+ * The producer writes into \ref back() and calls \ref publish() when the data is complete. The consumer calls \ref
+ * consume() and, if it returns true, reads the latest published data from \ref front(). Neither side ever waits for
+ * the other, the producer simply overwrites data that was published but not consumed yet.
+ */
+template<typename T>
+struct TripleBuffer
+{
+  /** Buffer owned by the producer */
+  inline T & back() noexcept { return buffers_[back_]; }
+
+  /** Publish the back buffer
+   *
+   * \returns True if the previously published buffer was never consumed, in that case \ref back() now holds that
+   * buffer
+   */
+  inline bool publish() noexcept
+  {
+    auto prev = state_.exchange(back_ | DIRTY, std::memory_order_acq_rel);
+    back_ = prev & INDEX;
+    return prev & DIRTY;
+  }
+
+  /** Take back the published buffer if it was not consumed yet
+   *
+   * This lets the producer accumulate data in a buffer until the consumer gets to it.
+   *
+   * \returns True if \ref back() now holds the unconsumed data, otherwise \ref back() holds stale data
+   */
+  inline bool reclaim() noexcept
+  {
+    auto prev = state_.exchange(back_, std::memory_order_acq_rel);
+    back_ = prev & INDEX;
+    return prev & DIRTY;
+  }
+
+  /** Acquire the latest published buffer
+   *
+   * \returns False if nothing was published since the last call, \ref front() must not be used in that case
+   */
+  inline bool consume() noexcept
+  {
+    if(!(state_.load(std::memory_order_acquire) & DIRTY)) { return false; }
+    /** The producer might have reclaimed the buffer in the meantime */
+    auto prev = state_.exchange(front_, std::memory_order_acq_rel);
+    front_ = prev & INDEX;
+    return prev & DIRTY;
+  }
+
+  /** Buffer owned by the consumer */
+  inline T & front() noexcept { return buffers_[front_]; }
+
+private:
+  static constexpr uint8_t INDEX = 0x3;
+  static constexpr uint8_t DIRTY = 0x4;
+  std::array<T, 3> buffers_;
+  uint8_t back_ = 0;
+  uint8_t front_ = 1;
+  /** Index of the middle buffer and dirty flag */
+  std::atomic<uint8_t> state_{2};
+};
+
+} // namespace mc_rtc::imgui
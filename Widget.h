@@ -1,7 +1,12 @@
 #pragma once
 
+#include "Hash.h"
+#include "LabelBuffer.h"
+#include "SlabPool.h"
+
 #include <imgui.h>
 
+#include <list>
 #include <memory>
 #include <string>
 
@@ -22,31 +27,111 @@ using ElementId = mc_control::ElementId;
 /** Forward declaration */
 struct Client;
 
-/** A widget in the GUI */
-struct Widget
+namespace form
+{
+
+struct Widget;
+
+} // namespace form
+
+/** Tag identifying a concrete widget type, this is used to check a widget type without RTTI */
+using WidgetType = const void *;
+
+template<typename T>
+inline WidgetType widget_type() noexcept
 {
-  inline Widget(Client & client, const ElementId & id) : client(client), id(id) {}
+  static const char tag = 0;
+  return &tag;
+}
+
+/** A widget in the GUI, widgets are allocated from their own pool */
+struct Widget : public SlabAllocated<Widget>
+{
+  inline Widget(Client & client, const ElementId & id) : client(client), id(id), label_id_(hash(id.category, id.name))
+  {
+  }
 
   virtual ~Widget() = default;
 
   Client & client;
   ElementId id;
-  bool seen = true;
-
-  /** Draw the 2D elements of the widget */
-  virtual void draw2D() {}
+  /** Generation of the last server message that contained this widget */
+  uint64_t generation = 0;
+  /** Position of the widget in the client's list of widgets ordered by generation */
+  std::list<Widget *>::iterator seen_it;
+  /** Concrete type of the widget, set by the client on creation */
+  WidgetType type = nullptr;
+  /** Height of the widget the last time it was drawn, used to skip drawing it while it is out of view */
+  float height = 0.0f;
+
+  /** Draw the 2D elements of the widget
+   *
+   * By default, widgets that can be drawn as a table row (see \ref row_columns) are drawn in their own table
+   */
+  virtual void draw2D()
+  {
+    int columns = row_columns();
+    if(columns == 0 || !ImGui::BeginTable(label("", "Table").c_str(), columns, ImGuiTableFlags_SizingStretchProp))
+    {
+      return;
+    }
+    ImGui::TableNextRow();
+    draw_row();
+    ImGui::EndTable();
+  }
+
+  /** Number of columns used by \ref draw_row, 0 if the widget cannot be drawn as a table row
+   *
+   * Consecutive widgets of a category with the same number of columns are drawn in a single table
+   */
+  virtual int row_columns() const noexcept { return 0; }
+
+  /** Draw the widget in the current row of a table with \ref row_columns columns */
+  virtual void draw_row() {}
 
   /** Draw the 3D elements of the widget */
   virtual void draw3D() {}
 
-  inline std::string label(std::string_view label, std::string_view extra = "")
-  { return fmt::format("{}##{}{}{}", label, id.category, id.name, extra); }
-
-  inline std::string label(std::string_view label, int i)
-  { return fmt::format("{}##{}{}{}", label, id.category, id.name, i); }
-
-  inline std::string label(std::string_view label, size_t i)
-  { return fmt::format("{}##{}{}{}", label, id.category, id.name, i); }
+  /** Collect the form elements with 3D content owned by this widget, the client draws them in its draw3D() */
+  virtual void collect3D(std::vector<form::Widget *> &) {}
+
+  /** True if the concrete type has 3D content, i.e. it overrides \ref draw3D or \ref collect3D */
+  template<typename T>
+  static constexpr bool has_3d() noexcept
+  {
+    return !std::is_same_v<decltype(&T::draw3D), void (Widget::*)()>
+           || !std::is_same_v<decltype(&T::collect3D), void (Widget::*)(std::vector<form::Widget *> &)>;
+  }
+
+  /** Returns true if the data differs from the data received last time
+   *
+   * This is used by the client to skip updating widgets whose data did not change
+   */
+  template<typename... Args>
+  inline bool changed(const Args &... args) noexcept
+  {
+    auto h = hash(args...);
+    if(h == data_hash_) { return false; }
+    data_hash_ = h;
+    return true;
+  }
+
+  /** Forget the data received last time, widgets must call this when they change their data locally
+   *
+   * The client also forgets the last state so that the next state is applied even if it is identical
+   */
+  void invalidate() noexcept;
+
+  /** Label unique to this widget, the suffix is used to distinguish labels with the same text in a widget */
+  template<typename... Args>
+  inline LabelBuffer label(std::string_view label, const Args &... suffix) const
+  { return LabelBuffer(label, label_id_, suffix...); }
+
+private:
+  /** Identifies the widget in its labels, computed once from the widget id */
+  uint64_t label_id_;
+  /** Hash of the data received last time, see \ref changed() */
+  uint64_t data_hash_ = 0;
 };
 
 using WidgetPtr = std::unique_ptr<Widget>;
@@ -0,0 +1,403 @@
+/** Headless benchmark of the client
+ *
+ * Synthetic GUI states are fed through the Client callbacks and the GUI is drawn into an ImGui context without any
+ * rendering backend. The benchmark reports the time spent ingesting each message, the time spent drawing each 2D and
+ * 3D frame and the heap allocations made by all of them.
+ *
+ * Usage: mc_rtc-imgui-benchmark [--categories N] [--widgets M] [--rows R] [--form-depth D] [--messages K]
+ *                               [--plots P] [--lines L] [--plot-samples S] [--replay FILE] [--tree]
+ *
+ * - N categories are created
+ * - each category has M widgets of every supported type, a table with R rows and a form with D nested objects and
+ *   interactive 3D inputs
+ * - P plots with L lines and a polygon are active, each line receives S samples per message
+ * - K messages are sent, a frame is drawn after each message
+ * - if a recording is provided (see Client::record), its messages are used instead of the synthetic ones
+ * - --tree draws the categories with Client::Navigation::Tree instead of tabs
+ */
+
+#include "../Client.h"
+
+#include <implot.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace
+{
+
+std::atomic<uint64_t> allocations{0};
+
+} // namespace
+
+void * operator new(size_t size)
+{
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if(void * out = std::malloc(size ? size : 1)) { return out; }
+  throw std::bad_alloc();
+}
+
+void operator delete(void * ptr) noexcept
+{ std::free(ptr); }
+
+void operator delete(void * ptr, size_t) noexcept
+{ std::free(ptr); }
+
+namespace mc_rtc::imgui
+{
+
+namespace
+{
+
+using clock = std::chrono::steady_clock;
+
+struct Params
+{
+  size_t categories = 10;
+  size_t widgets = 5;
+  size_t rows = 20;
+  size_t form_depth = 2;
+  size_t messages = 1000;
+  size_t plots = 2;
+  size_t lines = 4;
+  size_t plot_samples = 10;
+  std::string replay;
+  bool tree = false;
+};
+
+/** Marker that does nothing */
+struct NoMarker : public InteractiveMarker
+{
+  using InteractiveMarker::InteractiveMarker;
+
+  void mask(ControlAxis mask) override { mask_ = mask; }
+
+  void pose(const sva::PTransformd & pose) override { pose_ = pose; }
+
+  bool draw() override { return false; }
+};
+
+/** Client fed with a synthetic GUI state
+ *
+ * All the data is prepared beforehand so that the allocations made while feeding a message are the client's
+ */
+struct BenchClient : public Client
+{
+  BenchClient(const Params & params) : Client(Client::Offline{}), params_(params)
+  {
+    if(params.tree) { navigation(Navigation::Tree); }
+    if(params.replay.size())
+    {
+      replay_ = std::make_unique<Replay>(params.replay);
+      return;
+    }
+    for(size_t i = 0; i < params.categories; ++i)
+    {
+      auto & cat = categories_.emplace_back();
+      auto path = std::vector<std::string>{fmt::format("Category {}", i)};
+      for(size_t j = 0; j < params.widgets; ++j)
+      {
+        auto id = [&](const char * type) { return ElementId{path, fmt::format("{} {}", type, j)}; };
+        cat.labels.push_back(id("Label"));
+        cat.array_labels.push_back(id("ArrayLabel"));
+        cat.buttons.push_back(id("Button"));
+        cat.checkboxes.push_back(id("Checkbox"));
+        cat.string_inputs.push_back(id("StringInput"));
+        cat.integer_inputs.push_back(id("IntegerInput"));
+        cat.number_inputs.push_back(id("NumberInput"));
+        cat.number_sliders.push_back(id("NumberSlider"));
+        cat.array_inputs.push_back(id("ArrayInput"));
+        cat.combo_inputs.push_back(id("ComboInput"));
+        cat.data_combo_inputs.push_back(id("DataComboInput"));
+        cat.schemas.push_back(id("Schema"));
+      }
+      cat.table = ElementId{path, "Table"};
+      cat.form = ElementId{path, "Form"};
+    }
+    for(size_t i = 0; i < 2; ++i)
+    {
+      texts_[i] = fmt::format("Some text that changes ({})", i);
+      for(size_t r = 0; r < params.rows; ++r)
+      {
+        rows_[i].push_back({fmt::format("Row {}", r), fmt::format("{:.4f}", 0.1 * static_cast<double>(r + i)),
+                            fmt::format("{:.4f}", 0.2 * static_cast<double>(r + i)),
+                            fmt::format("{:.4f}", 0.3 * static_cast<double>(r + i))});
+      }
+    }
+    for(size_t i = 0; i < params.form_depth; ++i) { objects_.push_back(fmt::format("Object {}", i)); }
+    for(size_t i = 0; i < params.plots; ++i) { plot_titles_.push_back(fmt::format("Plot {}", i)); }
+    for(size_t i = 0; i < params.lines; ++i)
+    {
+      legends_.push_back(fmt::format("Line {}", i));
+      auto h = static_cast<double>(i) / static_cast<double>(params.lines);
+      colors_.push_back(mc_rtc::gui::Color(h, 1.0 - h, 0.5));
+    }
+    for(size_t i = 0; i < 2; ++i)
+    {
+      auto s = 0.5 + 0.5 * static_cast<double>(i);
+      polygons_[i] = mc_rtc::gui::plot::PolygonDescription({{-s, -s}, {s, -s}, {s, s}, {-s, s}},
+                                                           mc_rtc::gui::Color(0.0, 0.0, 1.0));
+      polygons_[i].fill(mc_rtc::gui::Color(0.0, 0.0, 1.0, 0.2));
+    }
+  }
+
+  InteractiveMarkerPtr make_marker(const sva::PTransformd & pose, ControlAxis mask) override
+  { return std::make_unique<NoMarker>(pose, mask); }
+
+  /** Number of messages to feed */
+  inline size_t messages() const noexcept { return replay_ ? replay_->size() : params_.messages; }
+
+  /** Feed the i-th message */
+  void message(size_t i)
+  {
+    if(replay_)
+    {
+      replay_->update(*this, false);
+      return;
+    }
+    const auto & text = texts_[i % 2];
+    const auto & rows = rows_[i % 2];
+    auto value = static_cast<double>(i % 100);
+    vector_.setConstant(value);
+    started();
+    for(const auto & cat : categories_)
+    {
+      for(size_t j = 0; j < params_.widgets; ++j)
+      {
+        label(cat.labels[j], text);
+        array_label(cat.array_labels[j], labels_, vector_);
+        button(cat.buttons[j]);
+        checkbox(cat.checkboxes[j], i % 2);
+        string_input(cat.string_inputs[j], text);
+        integer_input(cat.integer_inputs[j], static_cast<int>(i));
+        number_input(cat.number_inputs[j], value);
+        number_slider(cat.number_sliders[j], value, 0.0, 100.0);
+        array_input(cat.array_inputs[j], labels_, vector_);
+        combo_input(cat.combo_inputs[j], labels_, labels_[i % labels_.size()]);
+        data_combo_input(cat.data_combo_inputs[j], data_ref_, labels_[i % labels_.size()]);
+        schema(cat.schemas[j], "MetaTask");
+      }
+      table_start(cat.table, header_);
+      for(const auto & row : rows) { table_row(cat.table, row); }
+      table_end(cat.table);
+      form(cat.form);
+      for(const auto & object : objects_)
+      {
+        form_number_input(cat.form, "Number", true, value, true);
+        form_string_input(cat.form, "String", false, text, true);
+        start_form_object_input(object, true);
+      }
+      form_checkbox(cat.form, "Checkbox", true, true, true);
+      form_point3d_input(cat.form, "Point", false, point_, true, true);
+      form_transform_input(cat.form, "Transform", false, pose_, true, true);
+      for(size_t d = 0; d < objects_.size(); ++d) { end_form_object_input(); }
+    }
+    for(size_t p = 0; p < plot_titles_.size(); ++p)
+    {
+      start_plot(p, plot_titles_[p]);
+      plot_setup_xaxis(p, "t", {});
+      plot_setup_yaxis_left(p, "y", {});
+      for(size_t s = 0; s < params_.plot_samples; ++s)
+      {
+        /** Samples of a 1kHz controller */
+        auto t = 0.001 * static_cast<double>(i * params_.plot_samples + s);
+        for(size_t l = 0; l < legends_.size(); ++l)
+        {
+          plot_point(p, l, legends_[l], t, std::sin(t + static_cast<double>(l)), colors_[l],
+                     mc_rtc::gui::plot::Style::Solid, mc_rtc::gui::plot::Side::Left);
+        }
+      }
+      plot_polygon(p, legends_.size(), "Polygon", polygons_[i % 2], mc_rtc::gui::plot::Side::Left);
+      end_plot(p);
+    }
+    stopped();
+  }
+
+private:
+  struct CategoryIds
+  {
+    std::vector<ElementId> labels;
+    std::vector<ElementId> array_labels;
+    std::vector<ElementId> buttons;
+    std::vector<ElementId> checkboxes;
+    std::vector<ElementId> string_inputs;
+    std::vector<ElementId> integer_inputs;
+    std::vector<ElementId> number_inputs;
+    std::vector<ElementId> number_sliders;
+    std::vector<ElementId> array_inputs;
+    std::vector<ElementId> combo_inputs;
+    std::vector<ElementId> data_combo_inputs;
+    std::vector<ElementId> schemas;
+    ElementId table;
+    ElementId form;
+  };
+  Params params_;
+  std::unique_ptr<Replay> replay_;
+  std::vector<CategoryIds> categories_;
+  std::vector<std::string> labels_ = {"x", "y", "z", "rx", "ry", "rz"};
+  Eigen::VectorXd vector_ = Eigen::VectorXd::Zero(6);
+  std::vector<std::string> header_ = {"Name", "A", "B", "C"};
+  std::string texts_[2];
+  std::vector<std::vector<std::string>> rows_[2];
+  std::vector<std::string> objects_;
+  std::vector<std::string> data_ref_ = {"robots"};
+  Eigen::Vector3d point_ = Eigen::Vector3d::Zero();
+  sva::PTransformd pose_ = sva::PTransformd::Identity();
+  std::vector<std::string> plot_titles_;
+  std::vector<std::string> legends_;
+  std::vector<mc_rtc::gui::Color> colors_;
+  mc_rtc::gui::plot::PolygonDescription polygons_[2];
+};
+
+struct Samples
+{
+  std::vector<double> times;
+  std::vector<uint64_t> allocations;
+
+  void print(const char * name)
+  {
+    if(times.empty()) { return; }
+    std::sort(times.begin(), times.end());
+    auto at = [&](double q) { return times[static_cast<size_t>(q * static_cast<double>(times.size() - 1))]; };
+    double mean = 0;
+    for(auto t : times) { mean += t; }
+    mean /= static_cast<double>(times.size());
+    uint64_t total = 0;
+    for(auto a : allocations) { total += a; }
+    fmt::print("{:<16}{:>12.1f}{:>12.1f}{:>12.1f}{:>12.1f}{:>14.1f}{:>12}\n", name, mean, at(0.5), at(0.99),
+               times.back(), static_cast<double>(total) / static_cast<double>(allocations.size()),
+               *std::max_element(allocations.begin(), allocations.end()));
+  }
+};
+
+/** Run fn and record its duration and number of allocations */
+template<typename Fn>
+void measure(Samples & out, Fn && fn)
+{
+  auto allocs = allocations.load(std::memory_order_relaxed);
+  auto start = clock::now();
+  fn();
+  auto end = clock::now();
+  out.times.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+  out.allocations.push_back(allocations.load(std::memory_order_relaxed) - allocs);
+}
+
+Params parse(int argc, char * argv[])
+{
+  constexpr auto usage =
+      "Usage: {} [--categories N] [--widgets M] [--rows R] [--form-depth D] [--messages K] [--plots P] [--lines L]\n"
+      "          [--plot-samples S] [--replay FILE] [--tree]\n";
+  Params out;
+  for(int i = 1; i < argc; ++i)
+  {
+    auto arg = [&](const char * name, size_t & value)
+    {
+      if(std::strcmp(argv[i], name) != 0 || i + 1 >= argc) { return false; }
+      value = std::strtoul(argv[++i], nullptr, 10);
+      return true;
+    };
+    if(std::strcmp(argv[i], "--help") == 0)
+    {
+      fmt::print(usage, argv[0]);
+      std::exit(0);
+    }
+    if(std::strcmp(argv[i], "--tree") == 0)
+    {
+      out.tree = true;
+      continue;
+    }
+    if(std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+    {
+      out.replay = argv[++i];
+      continue;
+    }
+    if(!arg("--categories", out.categories) && !arg("--widgets", out.widgets) && !arg("--rows", out.rows)
+       && !arg("--form-depth", out.form_depth) && !arg("--messages", out.messages) && !arg("--plots", out.plots)
+       && !arg("--lines", out.lines) && !arg("--plot-samples", out.plot_samples))
+    {
+      mc_rtc::log::error("Unknown argument: {}", argv[i]);
+      fmt::print(usage, argv[0]);
+      std::exit(1);
+    }
+  }
+  out.messages = std::max<size_t>(out.messages, 2);
+  return out;
+}
+
+void run(const Params & params)
+{
+  ImGui::CreateContext();
+  ImPlot::CreateContext();
+  auto & io = ImGui::GetIO();
+  io.IniFilename = nullptr;
+  io.DisplaySize = ImVec2(1920, 1080);
+  io.DeltaTime = 1.0f / 60.0f;
+  /** Building the font atlas is all the ImGui needs from a backend */
+  unsigned char * pixels = nullptr;
+  int width = 0;
+  int height = 0;
+  io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+  {
+    BenchClient client(params);
+    Samples first_message, first_frame, messages, frames, frames3d;
+    /** Reserve the samples so that recording them does not allocate */
+    for(auto * samples : {&first_message, &first_frame, &messages, &frames, &frames3d})
+    {
+      samples->times.reserve(client.messages());
+      samples->allocations.reserve(client.messages());
+    }
+    auto frame = [&]()
+    {
+      ImGui::NewFrame();
+      client.draw2D(io.DisplaySize);
+      /** The 3D GUI is drawn within the ImGui frame as a backend would, its share of the frame is reported as well */
+      measure(frames3d, [&]() { client.draw3D(); });
+      ImGui::Render();
+    };
+    measure(first_message, [&]() { client.message(0); });
+    measure(first_frame, frame);
+    for(size_t i = 1; i < client.messages(); ++i)
+    {
+      measure(messages, [&]() { client.message(i); });
+      measure(frames, frame);
+    }
+    if(params.replay.size()) { fmt::print("Replay of {}, {} messages\n\n", params.replay, client.messages()); }
+    else
+    {
+      fmt::print("{} categories, {} widgets per type, {} rows per table, form depth {}, {} plots of {} lines, "
+                 "{} samples per line and message, {} messages\n\n",
+                 params.categories, params.widgets, params.rows, params.form_depth, params.plots, params.lines,
+                 params.plot_samples, params.messages);
+    }
+    fmt::print("{:<16}{:>12}{:>12}{:>12}{:>12}{:>14}{:>12}\n", "", "mean (us)", "median (us)", "p99 (us)", "max (us)",
+               "allocs (mean)", "allocs (max)");
+    first_message.print("first message");
+    messages.print("message");
+    first_frame.print("first frame");
+    frames.print("frame");
+    frames3d.print("frame (3D)");
+    const auto & widgets = client.widget_allocations();
+    const auto & forms = client.form_allocations();
+    fmt::print("\nwidgets: {} live, {} heap allocations, {} bytes in slabs\n", widgets.live, widgets.heap_allocations,
+               widgets.slab_bytes);
+    fmt::print("form elements: {} live, {} heap allocations, {} bytes in slabs\n", forms.live, forms.heap_allocations,
+               forms.slab_bytes);
+  }
+  ImPlot::DestroyContext();
+  ImGui::DestroyContext();
+}
+
+} // namespace
+
+} // namespace mc_rtc::imgui
+
+int main(int argc, char * argv[])
+{
+  mc_rtc::imgui::run(mc_rtc::imgui::parse(argc, argv));
+  return 0;
+}
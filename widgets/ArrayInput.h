@@ -58,6 +58,7 @@ struct ArrayInput : public Widget
           client.send_request(id, data_);
         }
         busy_ = false;
+        invalidate();
       }
       else
       {
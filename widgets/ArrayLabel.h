@@ -24,7 +24,7 @@ struct ArrayLabel : public Widget
     {
       bool text_hovered = ImGui::IsItemHovered();
       ImGui::SameLine();
-      ImGui::Text("%s", fmt::format("{:0.4f}", data_.norm()).c_str());
+      ImGui::Text("%.4f", data_.norm());
       if(text_hovered || ImGui::IsItemHovered())
       {
         ImGui::BeginTooltip();
@@ -54,7 +54,7 @@ struct ArrayLabel : public Widget
     if(ImGui::IsMouseHoveringRect(min, max))
     {
       ImGui::BeginTooltip();
-      ImGui::Text("%s", fmt::format("{:0.4f}", data_.norm()).c_str());
+      ImGui::Text("%.4f", data_.norm());
       ImGui::EndTooltip();
     }
   }
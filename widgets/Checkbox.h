@@ -15,7 +15,11 @@ struct Checkbox : public Widget
 
   inline void draw2D() override
   {
-    if(ImGui::Checkbox(label(id.name).c_str(), &data_)) { client.send_request(id); }
+    if(ImGui::Checkbox(label(id.name).c_str(), &data_))
+    {
+      invalidate();
+      client.send_request(id);
+    }
   }
 
 private:
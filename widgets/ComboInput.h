@@ -40,6 +40,7 @@ struct ComboInput : public Widget
           if(i != idx)
           {
             data_ = values_[i];
+            invalidate();
             client.send_request(id, data_);
           }
         }
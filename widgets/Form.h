@@ -46,7 +46,7 @@ struct Form : public Widget
     }
   }
 
-  void draw3D() override { object_->draw3D(); }
+  void collect3D(std::vector<form::Widget *> & out) override { object_->collect3D(out); }
 
   inline form::ObjectWidget * parentForm() noexcept { return object_.get(); }
 
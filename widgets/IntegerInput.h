@@ -15,10 +15,10 @@ struct IntegerInput : public SingleInput<int>
 
   int dataFromBuffer() override { return buffer_; }
 
-  inline void draw2D() override
+  inline void draw_row() override
   {
     int * data = busy_ ? &buffer_ : &data_;
-    SingleInput::draw2D(ImGui::InputInt, data, 0, 0);
+    SingleInput::draw_cells(ImGui::InputInt, data, 0, 0);
   }
 
 private:
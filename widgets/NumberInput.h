@@ -15,10 +15,10 @@ struct NumberInput : public SingleInput<double>
 
   double dataFromBuffer() override { return buffer_; }
 
-  inline void draw2D() override
+  inline void draw_row() override
   {
     double * data = busy_ ? &buffer_ : &data_;
-    SingleInput::draw2D(ImGui::InputDouble, data, 0.0, 0.0, "%.6g");
+    SingleInput::draw_cells(ImGui::InputDouble, data, 0.0, 0.0, "%.6g");
     if(ImGui::IsItemHovered())
     {
       ImGui::BeginTooltip();
@@ -18,14 +18,18 @@ struct NumberSlider : public Widget
     max_ = max;
   }
 
-  inline void draw2D() override
+  int row_columns() const noexcept override { return 2; }
+
+  inline void draw_row() override
   {
-    ImGui::BeginTable(label("", "Table").c_str(), 2, ImGuiTableFlags_SizingStretchProp);
     ImGui::TableNextColumn();
     ImGui::Text("%s", id.name.c_str());
     ImGui::TableNextColumn();
-    if(ImGui::SliderFloat(label("").c_str(), &data_, min_, max_)) { client.send_request(id, data_); }
-    ImGui::EndTable();
+    if(ImGui::SliderFloat(label("").c_str(), &data_, min_, max_))
+    {
+      invalidate();
+      client.send_request(id, data_);
+    }
   }
 
 private:
@@ -2,6 +2,8 @@
 
 #include "form/schema.h"
 
+#include "../Trace.h"
+
 #include <mc_rtc/config.h>
 
 namespace mc_rtc::imgui
@@ -145,6 +147,7 @@ Schema::~Schema() {}
 
 void Schema::data(const std::string & schema)
 {
+  MC_RTC_IMGUI_TRACE("Schema::data");
   if(schema == schema_) { return; }
   form_.reset(nullptr);
   schema_ = schema;
@@ -19,13 +19,13 @@ struct StringInput : public SingleInput<std::string>
 
   std::string dataFromBuffer() override { return {buffer_.data(), strnlen(buffer_.data(), buffer_.size())}; }
 
-  inline void draw2D() override
+  inline void draw_row() override
   {
     char * data = busy_ ? buffer_.data() : data_.data();
     size_t data_len = busy_ ? buffer_.size() : data_.size();
     auto InputText = [](const char * label, char * buffer, size_t len, int flags)
     { return ImGui::InputText(label, buffer, len, flags); };
-    SingleInput::draw2D(InputText, data, data_len);
+    SingleInput::draw_cells(InputText, data, data_len);
   }
 
 private:
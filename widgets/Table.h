@@ -2,43 +2,262 @@
 
 #include "Widget.h"
 
+#include <cmath>
+#include <cstdlib>
+#include <numeric>
+#include <string_view>
+
 namespace mc_rtc::imgui
 {
 
 struct Table : public Widget
 {
+  /** Tables with more rows are drawn in a scrolling region and show a filter */
+  static constexpr size_t MAX_VISIBLE_ROWS = 20;
+
   Table(Client & client, const ElementId & id) : Widget(client, id) {}
 
   void start(const std::vector<std::string> & header)
   {
-    header_ = header;
-    data_.clear();
+    next_row_ = 0;
+    changed_ = header_ != header;
+    if(changed_)
+    {
+      header_ = header;
+      truncate(0);
+    }
   }
 
-  void row(const std::vector<std::string> & row) { data_.push_back(row); }
+  void row(const std::vector<std::string> & row)
+  {
+    /** The table is usually the same from one message to the next, the rows are only stored again from the first one
+     * that differs */
+    if(!changed_)
+    {
+      if(next_row_ < rows_.size() && same(next_row_, row))
+      {
+        next_row_++;
+        return;
+      }
+      truncate(next_row_);
+      changed_ = true;
+    }
+    rows_.push_back(cells_.size());
+    for(const auto & c : row)
+    {
+      cells_.push_back({arena_.size(), c.size()});
+      arena_.append(c);
+      /** The filter cannot contain a new line so it never matches across two cells */
+      arena_.push_back('\n');
+    }
+    next_row_++;
+  }
 
-  void end() {}
+  void end()
+  {
+    if(next_row_ < rows_.size())
+    {
+      truncate(next_row_);
+      changed_ = true;
+    }
+    if(!changed_) { return; }
+    changed_ = false;
+    order_dirty_ = true;
+    /** Numeric columns are detected here so that sorting does not parse the data */
+    columns_.resize(header_.size());
+    numeric_.assign(header_.size(), true);
+    for(size_t c = 0; c < columns_.size(); ++c)
+    {
+      auto & column = columns_[c];
+      column.clear();
+      for(size_t r = 0; r < rows_.size(); ++r)
+      {
+        auto text = cell(r, c);
+        double value = std::nan("");
+        if(rows_[r] + c < row_end(r))
+        {
+          /** Every cell is followed by a new line in the arena so strtod stops within the cell or right after it */
+          char * end = nullptr;
+          value = std::strtod(text.data(), &end);
+          if(text.empty() || end != text.data() + text.size())
+          {
+            value = std::nan("");
+            numeric_[c] = false;
+          }
+        }
+        column.push_back(value);
+      }
+    }
+  }
 
   void draw2D() override
   {
-    auto drawVec = [](const std::vector<std::string> & vec)
+    ImGui::Text("%s", id.name.c_str());
+    if(header_.empty()) { return; }
+    if(rows_.size() > MAX_VISIBLE_ROWS || filter_.IsActive())
     {
-      for(const auto & v : vec)
+      if(filter_.Draw(label("Filter").c_str())) { view_dirty_ = true; }
+    }
+    auto columns = static_cast<int>(header_.size());
+    ImGuiTableFlags flags = ImGuiTableFlags_SizingStretchProp | ImGuiTableFlags_Sortable | ImGuiTableFlags_SortTristate;
+    ImVec2 size(0.0f, 0.0f);
+    if(rows_.size() > MAX_VISIBLE_ROWS)
+    {
+      flags |= ImGuiTableFlags_ScrollY;
+      size.y = static_cast<float>(MAX_VISIBLE_ROWS + 1) * ImGui::GetTextLineHeightWithSpacing();
+    }
+    if(!ImGui::BeginTable(label("", "_table_data").c_str(), columns, flags, size)) { return; }
+    ImGui::TableSetupScrollFreeze(0, 1);
+    for(const auto & h : header_) { ImGui::TableSetupColumn(h.c_str()); }
+    if(auto * specs = ImGui::TableGetSortSpecs(); specs && specs->SpecsDirty)
+    {
+      sort_column_ = specs->SpecsCount ? specs->Specs[0].ColumnIndex : -1;
+      sort_descending_ = specs->SpecsCount && specs->Specs[0].SortDirection == ImGuiSortDirection_Descending;
+      specs->SpecsDirty = false;
+      order_dirty_ = true;
+    }
+    ImGui::TableHeadersRow();
+    update_view();
+    /** Only the visible rows are drawn */
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(view_.size()));
+    while(clipper.Step())
+    {
+      for(int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
       {
-        ImGui::TableNextColumn();
-        ImGui::Text("%s", v.c_str());
+        ImGui::TableNextRow();
+        auto row = view_[static_cast<size_t>(i)];
+        for(size_t c = 0; c < header_.size(); ++c)
+        {
+          ImGui::TableNextColumn();
+          auto text = cell(row, c);
+          ImGui::TextUnformatted(text.data(), text.data() + text.size());
+        }
       }
-    };
-    ImGui::Text("%s", id.name.c_str());
-    ImGui::BeginTable(label("", "_table_data").c_str(), header_.size(), ImGuiTableFlags_SizingStretchProp);
-    drawVec(header_);
-    for(const auto & d : data_) { drawVec(d); }
+    }
     ImGui::EndTable();
   }
 
 private:
+  /** Location of a cell in arena_ */
+  struct Cell
+  {
+    size_t offset;
+    size_t size;
+  };
   std::vector<std::string> header_;
-  std::vector<std::vector<std::string>> data_;
+  /** Content of all the cells, one after the other */
+  std::string arena_;
+  /** All cells, row by row */
+  std::vector<Cell> cells_;
+  /** Index of the first cell of each row in cells_ */
+  std::vector<size_t> rows_;
+  /** Numeric value of every cell for each column, NaN if the cell is not a number */
+  std::vector<std::vector<double>> columns_;
+  /** True if every cell of the column is a number */
+  std::vector<bool> numeric_;
+  /** Index of the next row received in the current message */
+  size_t next_row_ = 0;
+  /** True if the current message changed the table, the columns and the sort order are only computed again then */
+  bool changed_ = false;
+
+  ImGuiTextFilter filter_;
+  /** Column used to sort the rows, -1 to keep the order of the server */
+  int sort_column_ = -1;
+  bool sort_descending_ = false;
+  /** Rows in the sort order */
+  std::vector<size_t> order_;
+  /** Rows in the sort order that pass the filter */
+  std::vector<size_t> view_;
+  bool order_dirty_ = true;
+  bool view_dirty_ = true;
+
+  /** Index of the cell after the last cell of a row in cells_ */
+  inline size_t row_end(size_t row) const noexcept { return row + 1 < rows_.size() ? rows_[row + 1] : cells_.size(); }
+
+  inline std::string_view cell(size_t row, size_t column) const noexcept
+  {
+    auto begin = rows_[row] + column;
+    if(begin >= row_end(row)) { return {}; }
+    return {arena_.data() + cells_[begin].offset, cells_[begin].size};
+  }
+
+  /** True if the stored row is the same as the given one */
+  bool same(size_t row, const std::vector<std::string> & data) const noexcept
+  {
+    if(row_end(row) - rows_[row] != data.size()) { return false; }
+    for(size_t c = 0; c < data.size(); ++c)
+    {
+      if(cell(row, c) != data[c]) { return false; }
+    }
+    return true;
+  }
+
+  /** Only keep the given number of rows, the capacity is kept for the next message */
+  void truncate(size_t rows) noexcept
+  {
+    if(rows >= rows_.size()) { return; }
+    auto first = rows_[rows];
+    arena_.resize(first < cells_.size() ? cells_[first].offset : arena_.size());
+    cells_.resize(first);
+    rows_.resize(rows);
+  }
+
+  void update_view()
+  {
+    if(order_dirty_)
+    {
+      order_.resize(rows_.size());
+      std::iota(order_.begin(), order_.end(), 0);
+      if(sort_column_ >= 0 && static_cast<size_t>(sort_column_) < header_.size())
+      {
+        auto c = static_cast<size_t>(sort_column_);
+        auto sort = [&](auto && less)
+        {
+          if(sort_descending_)
+          {
+            std::stable_sort(order_.begin(), order_.end(), [&](size_t a, size_t b) { return less(b, a); });
+          }
+          else
+          {
+            std::stable_sort(order_.begin(), order_.end(), less);
+          }
+        };
+        if(numeric_[c])
+        {
+          /** Missing cells and "nan" are NaN, they are ordered after numbers so that this is a strict weak ordering */
+          auto less = [&](size_t a, size_t b)
+          {
+            double va = columns_[c][a];
+            double vb = columns_[c][b];
+            return std::isnan(vb) ? !std::isnan(va) : va < vb;
+          };
+          sort(less);
+        }
+        else
+        {
+          sort([&](size_t a, size_t b) { return cell(a, c) < cell(b, c); });
+        }
+      }
+      order_dirty_ = false;
+      view_dirty_ = true;
+    }
+    if(view_dirty_)
+    {
+      view_.clear();
+      for(auto row : order_)
+      {
+        /** The cells of a row are contiguous in the arena (separated by new lines), the filter is applied on the whole
+         * row */
+        auto begin = rows_[row];
+        auto end = row_end(row);
+        const char * text = arena_.data() + (begin < end ? cells_[begin].offset : 0);
+        const char * text_end = begin < end ? arena_.data() + cells_[end - 1].offset + cells_[end - 1].size : text;
+        if(filter_.PassFilter(text, text_end)) { view_.push_back(row); }
+      }
+      view_dirty_ = false;
+    }
+  }
 };
 
 } // namespace mc_rtc::imgui
@@ -21,10 +21,12 @@ struct SingleInput : public Widget
 
   virtual DataT dataFromBuffer() = 0;
 
+  int row_columns() const noexcept override { return 3; }
+
+  /** Draw the name, the Edit/Done button and the input in the current table row */
   template<typename ImGuiFn, typename... Args>
-  void draw2D(ImGuiFn fn, Args &&... args)
+  void draw_cells(ImGuiFn fn, Args &&... args)
   {
-    ImGui::BeginTable(label("", "Table").c_str(), 3, ImGuiTableFlags_SizingStretchProp);
     ImGui::TableNextColumn();
     ImGui::Text("%s", id.name.c_str());
     ImGui::TableNextColumn();
@@ -55,9 +57,9 @@ struct SingleInput : public Widget
           data_ = nData;
         }
         busy_ = false;
+        invalidate();
       }
     }
-    ImGui::EndTable();
   }
 
 protected:
@@ -29,7 +29,11 @@ void ArrayInput::draw_()
       for(size_t i = 0; i < static_cast<size_t>(temp_.size()); ++i)
       {
         ImGui::TableNextColumn();
-        ImGui::Text("%s", i < labels_.size() ? labels_[i].c_str() : std::to_string(i).c_str());
+        if(i < labels_.size()) { ImGui::Text("%s", labels_[i].c_str()); }
+        else
+        {
+          ImGui::Text("%zu", i);
+        }
       }
     }
   }
@@ -38,10 +42,14 @@ void ArrayInput::draw_()
     if(table_layout) { ImGui::TableNextColumn(); }
     else
     {
-      ImGui::Text("%s", i < labels_.size() ? labels_[i].c_str() : std::to_string(i).c_str());
+      if(i < labels_.size()) { ImGui::Text("%s", labels_[i].c_str()); }
+      else
+      {
+        ImGui::Text("%zu", i);
+      }
       ImGui::SameLine();
     }
-    if(ImGui::InputDouble(label("", fmt::format("{}", i)).c_str(), &temp_(i)))
+    if(ImGui::InputDouble(label("", i).c_str(), &temp_(i)))
     {
       value_ = temp_;
       locked_ = true;
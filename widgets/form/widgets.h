@@ -22,14 +22,22 @@ using ObjectWidgetPtr = std::unique_ptr<ObjectWidget>;
 struct OneOfWidget;
 using OneOfWidgetPtr = std::unique_ptr<OneOfWidget>;
 
-struct Widget
+/** A form element, form elements are allocated from their own pool */
+struct Widget : public SlabAllocated<Widget>
 {
   Widget(const ::mc_rtc::imgui::Widget & parent, const std::string & name)
-  : parent_(parent), name_(name), id_(next_id_++)
+  : parent_(parent), name_(name), id_(next_id_++), label_id_(hash(parent.id.category, parent.id.name, name))
   {
+    structure_version_++;
   }
 
-  virtual ~Widget() = default;
+  virtual ~Widget() { structure_version_++; }
+
+  /** Changes every time a form element is created or destroyed
+   *
+   * The client uses this to know when the list of elements with 3D content must be collected again
+   */
+  static inline uint64_t structure_version() noexcept { return structure_version_; }
 
   /** Should return a copy of the form widget
    *
@@ -51,7 +59,7 @@ struct Widget
   {
     if(hidden_) return;
     parent_.client.enable_bold_font();
-    ImGui::Text("%s", name().c_str());
+    ImGui::TextUnformatted(name_.c_str(), name_.c_str() + std::min(name_.find("##"), name_.size()));
     parent_.client.disable_bold_font();
     if(locked_)
     {
@@ -65,6 +73,10 @@ struct Widget
 
   virtual void draw3D() {}
 
+  /** Collect the elements with 3D content, i.e. the elements whose draw3D() does something, containers collect the
+   * elements they would draw */
+  virtual void collect3D(std::vector<Widget *> &) {}
+
   /** A form widget is trivial if it doesn't contain other widgets */
   inline virtual bool trivial() const { return true; }
 
@@ -73,9 +85,10 @@ struct Widget
 
   virtual void collect(mc_rtc::Configuration & out) = 0;
 
-  template<typename T = const char *>
-  inline std::string label(std::string_view label, T suffix = "")
-  { return fmt::format("{}##{}{}{}{}_{}", label, parent_.id.category, parent_.id.name, name_, suffix, id_); }
+  /** Label unique to this element, the suffix is used to distinguish labels with the same text in an element */
+  template<typename... Args>
+  inline LabelBuffer label(std::string_view label, const Args &... suffix) const
+  { return LabelBuffer(label, label_id_, suffix..., '_', id_); }
 
   inline std::string name() const
   {
@@ -109,6 +122,10 @@ protected:
   /** Unique id to further disambiguate labels */
   uint64_t id_ = 0;
   inline static uint64_t next_id_ = 0;
+  /** Identifies the element in its labels, computed once on creation */
+  uint64_t label_id_ = 0;
+  /** See \ref structure_version() */
+  inline static uint64_t structure_version_ = 0;
   bool locked_ = false;
   bool hidden_ = false;
 };
@@ -172,10 +189,10 @@ struct ObjectWidget : public Widget
     if(!is_root) { ImGui::Unindent(); }
   }
 
-  void draw3D() override
+  void collect3D(std::vector<Widget *> & out) override
   {
-    for(auto & w : requiredWidgets_) { w->draw3D(); }
-    for(auto & w : otherWidgets_) { w->draw3D(); }
+    for(auto & w : requiredWidgets_) { w->collect3D(out); }
+    for(auto & w : otherWidgets_) { w->collect3D(out); }
   }
 
   bool trivial() const override { return false; }
@@ -313,9 +330,9 @@ struct ObjectArrayWidget : public Widget
     ImGui::Unindent();
   }
 
-  void draw3D() override
+  void collect3D(std::vector<Widget *> & out) override
   {
-    for(auto & o : objects_) { o->draw3D(); }
+    for(auto & o : objects_) { o->collect3D(out); }
   }
 
   bool trivial() const override { return false; }
@@ -480,9 +497,9 @@ struct OneOfWidget : public Widget
     ImGui::Unindent();
   }
 
-  void draw3D() override
+  void collect3D(std::vector<Widget *> & out) override
   {
-    if(active_) { active_->draw3D(); }
+    if(active_) { active_->collect3D(out); }
   }
 
   bool trivial() const override { return false; }
@@ -755,7 +772,7 @@ struct InteractiveMarkerInput : public SimpleInput<DataT>
     for(size_t i = 0; i < 3; ++i)
     {
       ImGui::TableNextColumn();
-      if(ImGui::InputDouble(this->label("", fmt::format("table_translation_{}", i)).c_str(), &data(i)))
+      if(ImGui::InputDouble(this->label("", "table_translation_", i).c_str(), &data(i)))
       {
         if constexpr(std::is_same_v<DataT, Eigen::Vector3d>)
         {
@@ -796,7 +813,7 @@ struct InteractiveMarkerInput : public SimpleInput<DataT>
     for(size_t i = 0; i < 4; ++i)
     {
       ImGui::TableNextColumn();
-      if(ImGui::InputDouble(this->label("", fmt::format("table_quaternion_{}", i)).c_str(), get_ptr(i)))
+      if(ImGui::InputDouble(this->label("", "table_quaternion_", i).c_str(), get_ptr(i)))
       {
         this->temp_.rotation() = quat.toRotationMatrix();
         this->value_ = this->temp_;
@@ -807,6 +824,8 @@ struct InteractiveMarkerInput : public SimpleInput<DataT>
     ImGui::EndTable();
   }
 
+  inline void collect3D(std::vector<Widget *> & out) override { out.push_back(this); }
+
   inline void draw3D() override
   {
     if(!interactive_) { return; }